@@ -0,0 +1,150 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "simlib.h"
+#include "arrival_trace.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*******************************************************************************/
+
+typedef struct _arrival_trace_header_
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+} Arrival_Trace_Header;
+
+static int
+arrival_trace_header_ok(const Arrival_Trace_Header * header)
+{
+  return memcmp(header->magic, ARRIVAL_TRACE_MAGIC, sizeof(header->magic)) == 0
+    && header->version == ARRIVAL_TRACE_VERSION
+    && header->record_size == sizeof(Arrival_Record);
+}
+
+/*
+ * Open an arrival trace. Returns NULL (after printing a warning) if the file
+ * can't be opened or isn't an arrival trace.
+ */
+
+Arrival_Trace_Ptr
+arrival_trace_open(const char * file_name)
+{
+  Arrival_Trace_Ptr trace;
+
+  trace = (Arrival_Trace_Ptr) xcalloc(1, sizeof(Arrival_Trace));
+
+#ifndef _WIN32
+  {
+    struct stat file_status;
+    int fd;
+
+    if ((fd = open(file_name, O_RDONLY)) < 0 || fstat(fd, &file_status) != 0 ||
+	(size_t) file_status.st_size < sizeof(Arrival_Trace_Header) ||
+	(trace->mapping = mmap(NULL, (size_t) file_status.st_size, PROT_READ,
+			       MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+      printf("Warning: Cannot map arrival trace %s\n", file_name);
+      if (fd >= 0) close(fd);
+      xfree(trace);
+      return NULL;
+    }
+    close(fd);
+
+    trace->mapped_size = (size_t) file_status.st_size;
+    madvise(trace->mapping, trace->mapped_size, MADV_SEQUENTIAL);
+
+    if (!arrival_trace_header_ok((const Arrival_Trace_Header *) trace->mapping)) {
+      printf("Warning: %s is not an arrival trace\n", file_name);
+      munmap(trace->mapping, trace->mapped_size);
+      xfree(trace);
+      return NULL;
+    }
+
+    trace->records = (const Arrival_Record *)
+      ((const char *) trace->mapping + sizeof(Arrival_Trace_Header));
+    trace->number_of_records = (trace->mapped_size -
+				sizeof(Arrival_Trace_Header))/sizeof(Arrival_Record);
+  }
+#else
+  /* No mmap here. Read the records one at a time through stdio. */
+  {
+    Arrival_Trace_Header header;
+    FILE * fp;
+
+    if ((fp = fopen(file_name, "rb")) == NULL ||
+	fread(&header, sizeof(header), 1, fp) != 1 ||
+	!arrival_trace_header_ok(&header)) {
+      printf("Warning: Cannot read arrival trace %s\n", file_name);
+      if (fp != NULL) fclose(fp);
+      xfree(trace);
+      return NULL;
+    }
+    trace->file = (void *) fp;
+  }
+#endif
+
+  trace->next = 0;
+  trace->source = NULL;
+  trace->next_trace = NULL;
+  return trace;
+}
+
+/*
+ * Get the next arrival record, or NULL at the end of the trace. The record
+ * stays valid until the next call.
+ */
+
+const Arrival_Record *
+arrival_trace_next(Arrival_Trace_Ptr trace)
+{
+#ifndef _WIN32
+  if (trace->next >= trace->number_of_records) return NULL;
+  return trace->records + trace->next++;
+#else
+  if (fread(&trace->buffer, sizeof(Arrival_Record), 1,
+	    (FILE *) trace->file) != 1) return NULL;
+  trace->next++;
+  return &trace->buffer;
+#endif
+}
+
+void
+arrival_trace_close(Arrival_Trace_Ptr trace)
+{
+#ifndef _WIN32
+  munmap(trace->mapping, trace->mapped_size);
+#else
+  fclose((FILE *) trace->file);
+#endif
+  xfree(trace);
+}
+
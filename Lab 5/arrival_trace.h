@@ -0,0 +1,92 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _ARRIVAL_TRACE_H_
+#define _ARRIVAL_TRACE_H_
+
+/*******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include "simlib.h"
+
+/*******************************************************************************/
+
+/*
+ * Recorded arrivals for trace-driven simulation. A trace file holds a header
+ * followed by fixed-size arrival records in time order (native byte order):
+ *
+ *   header:  "ALOHAARR", uint32 version, uint32 record size
+ *   records: double time, double upload_time, double service_time,
+ *            int32 station_id, int32 reserved
+ *
+ * The file is memory mapped and read sequentially in place, so traces much
+ * larger than memory stream through without being loaded.
+ */
+
+#define ARRIVAL_TRACE_MAGIC "ALOHAARR"
+#define ARRIVAL_TRACE_VERSION 1
+
+typedef struct _arrival_record_
+{
+  double time;
+  double upload_time;
+  double service_time;
+  int32_t station_id;
+  int32_t reserved;
+} Arrival_Record, * Arrival_Record_Ptr;
+
+typedef struct _arrival_trace_
+{
+  const Arrival_Record * records;
+  size_t number_of_records;
+  size_t next;
+  const Arrival_Record * current;
+  void * mapping;
+  size_t mapped_size;
+  void * file;
+  Arrival_Record buffer;
+  Event_Source_Ptr source;
+  struct _arrival_trace_ * next_trace;
+} Arrival_Trace, * Arrival_Trace_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Arrival_Trace_Ptr
+arrival_trace_open(const char *);
+
+const Arrival_Record *
+arrival_trace_next(Arrival_Trace_Ptr);
+
+void
+arrival_trace_close(Arrival_Trace_Ptr);
+
+/*******************************************************************************/
+
+#endif /* arrival_trace.h */
+
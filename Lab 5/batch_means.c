@@ -0,0 +1,204 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <math.h>
+#include "batch_means.h"
+
+/*******************************************************************************/
+
+/*
+ * Batches whose means have a lag-1 autocorrelation above this are too short
+ * to be treated as independent.
+ */
+
+#define MAX_AUTOCORRELATION 0.2
+
+/*******************************************************************************/
+
+void
+batch_means_initialize(Batch_Means_Ptr batches, long int batch_size,
+		       double now)
+{
+  batches->batch_size = batch_size;
+  batches->count = 0;
+  batches->sum = 0.0;
+  batches->batch_start_time = now;
+  batches->number_of_batches = 0;
+}
+
+/*
+ * Merge adjacent pairs of batches into batches twice as long.
+ */
+
+static void
+batch_means_merge(Batch_Means_Ptr batches)
+{
+  int i;
+
+  for (i=0; i<batches->number_of_batches/2; i++) {
+    batches->mean[i] = (batches->mean[2*i] + batches->mean[2*i+1])/2;
+    batches->duration[i] = batches->duration[2*i] + batches->duration[2*i+1];
+  }
+  batches->number_of_batches /= 2;
+  batches->batch_size *= 2;
+}
+
+/*
+ * Add a delay observation made at time now. Returns 1 when this completes a
+ * batch, and 0 otherwise. If the completed batches are still correlated, the
+ * batch size is doubled right away rather than waiting for the batches to run
+ * out.
+ */
+
+int
+batch_means_add(Batch_Means_Ptr batches, double delay, double now)
+{
+  batches->sum += delay;
+
+  if (++batches->count < batches->batch_size) return 0;
+
+  batches->mean[batches->number_of_batches] = batches->sum/batches->count;
+  batches->duration[batches->number_of_batches] =
+    now - batches->batch_start_time;
+  batches->number_of_batches++;
+
+  batches->count = 0;
+  batches->sum = 0.0;
+  batches->batch_start_time = now;
+
+  if (batches->number_of_batches == MAX_BATCHES ||
+      (batches->number_of_batches >= 2*MIN_BATCHES &&
+       batches->number_of_batches % 2 == 0 &&
+       batch_means_autocorrelation(batches) > MAX_AUTOCORRELATION)) {
+    batch_means_merge(batches);
+  }
+  return 1;
+}
+
+/*
+ * Confidence interval (95%) from a set of batch values, or of any other
+ * independent values.
+ */
+
+Confidence_Interval
+confidence_interval(double * value, int n)
+{
+  Confidence_Interval ci;
+  double sum = 0.0, sum_of_squares = 0.0;
+  int i;
+
+  ci.mean = 0.0;
+  ci.half_width = HUGE_VAL;
+  if (n < 2) return ci;
+
+  for (i=0; i<n; i++) sum += value[i];
+  ci.mean = sum/n;
+
+  for (i=0; i<n; i++) sum_of_squares += (value[i]-ci.mean)*(value[i]-ci.mean);
+  ci.half_width = student_t_quantile(n-1) * sqrt(sum_of_squares/(n-1)/n);
+  return ci;
+}
+
+Confidence_Interval
+batch_means_delay(Batch_Means_Ptr batches)
+{
+  return confidence_interval(batches->mean, batches->number_of_batches);
+}
+
+Confidence_Interval
+batch_means_throughput(Batch_Means_Ptr batches)
+{
+  double throughput[MAX_BATCHES];
+  int i;
+
+  for (i=0; i<batches->number_of_batches; i++) {
+    throughput[i] = batches->batch_size/batches->duration[i];
+  }
+  return confidence_interval(throughput, batches->number_of_batches);
+}
+
+/*
+ * Lag-1 autocorrelation of the batch means of delay.
+ */
+
+double
+batch_means_autocorrelation(Batch_Means_Ptr batches)
+{
+  double mean = 0.0, variance = 0.0, covariance = 0.0;
+  int i, n;
+
+  n = batches->number_of_batches;
+  if (n < 3) return 1.0;
+
+  for (i=0; i<n; i++) mean += batches->mean[i];
+  mean /= n;
+
+  for (i=0; i<n; i++) {
+    variance += (batches->mean[i]-mean)*(batches->mean[i]-mean);
+    if (i > 0) covariance += (batches->mean[i]-mean)*(batches->mean[i-1]-mean);
+  }
+  return variance > 0.0 ? covariance/variance : 0.0;
+}
+
+/*
+ * Test whether the delay and throughput estimates have reached the requested
+ * relative precision, i.e., confidence interval half-width over mean.
+ */
+
+int
+batch_means_converged(Batch_Means_Ptr batches, double relative_precision)
+{
+  Confidence_Interval delay, throughput;
+
+  if (batches->number_of_batches < MIN_BATCHES) return 0;
+  if (batch_means_autocorrelation(batches) > MAX_AUTOCORRELATION) return 0;
+
+  delay = batch_means_delay(batches);
+  throughput = batch_means_throughput(batches);
+
+  return delay.half_width <= relative_precision * delay.mean &&
+    throughput.half_width <= relative_precision * throughput.mean;
+}
+
+/*
+ * Two-sided 95% quantile of Student's t distribution, using the
+ * Cornish-Fisher expansion about the normal quantile. This is within 0.2% for
+ * ten or more degrees of freedom, and within 4% down to three.
+ */
+
+double
+student_t_quantile(int degrees_of_freedom)
+{
+  double z = 1.959964, z3, z5, n;
+
+  if (degrees_of_freedom < 1) return HUGE_VAL;
+  if (degrees_of_freedom == 1) return 12.706;
+  if (degrees_of_freedom == 2) return 4.303;
+
+  n = degrees_of_freedom;
+  z3 = z*z*z;
+  z5 = z3*z*z;
+  return z + (z3 + z)/(4*n) + (5*z5 + 16*z3 + 3*z)/(96*n*n);
+}
+
@@ -0,0 +1,90 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _BATCH_MEANS_H_
+#define _BATCH_MEANS_H_
+
+/*******************************************************************************/
+
+/*
+ * Non-overlapping batch means of packet delay and throughput. At most
+ * MAX_BATCHES batches are kept. When they are all used, adjacent batches are
+ * merged, halving the number of batches and doubling the batch size, so the
+ * memory used stays fixed however long the run is.
+ */
+
+#define MAX_BATCHES 64
+#define MIN_BATCHES 20
+
+typedef struct _batch_means_
+{
+  long int batch_size;
+  long int count;
+  double sum;
+  double batch_start_time;
+  int number_of_batches;
+  double mean[MAX_BATCHES];
+  double duration[MAX_BATCHES];
+} Batch_Means, * Batch_Means_Ptr;
+
+typedef struct _confidence_interval_
+{
+  double mean;
+  double half_width;
+} Confidence_Interval;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+batch_means_initialize(Batch_Means_Ptr, long int, double);
+
+int
+batch_means_add(Batch_Means_Ptr, double, double);
+
+Confidence_Interval
+confidence_interval(double *, int);
+
+Confidence_Interval
+batch_means_delay(Batch_Means_Ptr);
+
+Confidence_Interval
+batch_means_throughput(Batch_Means_Ptr);
+
+double
+batch_means_autocorrelation(Batch_Means_Ptr);
+
+int
+batch_means_converged(Batch_Means_Ptr, double);
+
+double
+student_t_quantile(int);
+
+/*******************************************************************************/
+
+#endif /* batch_means.h */
+
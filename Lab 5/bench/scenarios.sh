@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# End-to-end scenario matrix. The full model is built once per combination of
+# NUMBER_OF_STATIONS, PACKET_ARRIVAL_RATE and MEAN_BACKOFF_DURATION, and run
+# for a fixed budget of events. The results are written as CSV to stdout:
+# events per CPU second, peak resident memory and the event list high-water
+# mark.
+#
+# Usage:  bench/scenarios.sh
+#
+# The matrix and the budget can be changed through the environment, e.g.,
+#   STATIONS="2 1000" RATES="0.1" BACKOFFS="10" BUDGET=1000000 bench/scenarios.sh
+
+STATIONS=${STATIONS:-"2 10 100 1000 10000 100000"}
+RATES=${RATES:-"0.05 0.2 0.4"}
+BACKOFFS=${BACKOFFS:-"1 10 100"}
+BUDGET=${BUDGET:-5000000}
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-O2"}
+
+SOURCE=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "stations,arrival_rate,mean_backoff,events,cpu_seconds,events_per_sec,peak_rss_kb,eventlist_hwm"
+
+for stations in $STATIONS; do
+  for rate in $RATES; do
+    for backoff in $BACKOFFS; do
+      if ! $CC $CFLAGS -DNUMBER_OF_STATIONS=$stations \
+	  -DPACKET_ARRIVAL_RATE=$rate -DMEAN_BACKOFF_DURATION=$backoff \
+	  -DEVENT_BUDGET=$BUDGET -DRUNLENGTH=2000000000 -DBENCHMARK_SUMMARY=1 \
+	  -o "$WORK/aloha" "$SOURCE"/*.c -lm -lpthread -lrt; then
+	echo "$stations,$rate,$backoff,build failed" >&2
+	continue
+      fi
+
+      # Everything but the summary line goes away.
+      (cd "$WORK" && ./aloha < /dev/null) |
+	sed -n 's/^Benchmark: //p' |
+	sed 's/[a-z_]*=//g; s/ /,/g'
+    done
+  done
+done
@@ -0,0 +1,363 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+/*
+ * Microbenchmarks of the simlib primitives: the schedule/execute cycle
+ * (the "hold" model, with the event list kept at a fixed size), deschedule,
+ * FIFO queues, servers and the random number generators. Each benchmark
+ * reports the time and the number of heap allocations per operation.
+ * Allocations are counted by wrapping malloc, calloc and free at link time.
+ *
+ * Build and run with:  make -C bench run
+ * Usage:               simlib_bench [operations]
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "simlib.h"
+
+/*******************************************************************************/
+
+#define DEFAULT_OPERATIONS 2000000
+#define INCREMENTS 65536 /* a power of two */
+
+static long int operations = DEFAULT_OPERATIONS;
+
+/*
+ * Allocation counting. The linker sends malloc, calloc and free here
+ * (-Wl,--wrap=malloc,--wrap=calloc,--wrap=free).
+ */
+
+static unsigned long allocations = 0;
+
+void * __real_malloc(size_t);
+void * __real_calloc(size_t, size_t);
+void __real_free(void *);
+
+void *
+__wrap_malloc(size_t size)
+{
+  allocations++;
+  return __real_malloc(size);
+}
+
+void *
+__wrap_calloc(size_t count, size_t size)
+{
+  allocations++;
+  return __real_calloc(count, size);
+}
+
+void
+__wrap_free(void * ptr)
+{
+  __real_free(ptr);
+}
+
+/*
+ * Timing.
+ */
+
+static double start_time;
+static unsigned long start_allocations;
+
+static double
+wall_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+static void
+benchmark_start(void)
+{
+  start_allocations = allocations;
+  start_time = wall_time();
+}
+
+static void
+benchmark_report(const char * name, const char * parameters, long int count)
+{
+  double elapsed = wall_time() - start_time;
+
+  printf("%-26s %-22s %10.1f %12.3f\n", name, parameters,
+	 1e9 * elapsed/count,
+	 (double) (allocations - start_allocations)/count);
+  fflush(stdout);
+}
+
+/*******************************************************************************/
+
+/*
+ * The hold model: every event executed schedules one new event a random
+ * increment later, so the event list stays at its initial size. The
+ * increments are generated beforehand so that only the event list is timed.
+ */
+
+typedef enum {EXPONENTIAL, UNIFORM, CONSTANT, BIMODAL} Distribution;
+
+static const char * distribution_names[] = {
+  "exponential", "uniform", "constant", "bimodal"
+};
+
+static double increments[INCREMENTS];
+static unsigned long next_increment;
+
+static void
+hold_event(Simulation_Run_Ptr simulation_run, void * attachment)
+{
+  Event event;
+
+  event.description = "Hold";
+  event.function = hold_event;
+  event.attachment = attachment;
+
+  simulation_run_schedule_event(simulation_run, event,
+	simulation_run_get_time(simulation_run) +
+	increments[next_increment++ & (INCREMENTS - 1)]);
+}
+
+static void
+make_increments(Distribution distribution)
+{
+  int i;
+
+  for (i=0; i<INCREMENTS; i++) {
+    switch (distribution) {
+    case EXPONENTIAL:
+      increments[i] = exponential_generator(1.0);
+      break;
+    case UNIFORM:
+      increments[i] = 2.0 * uniform_generator();
+      break;
+    case CONSTANT:
+      increments[i] = 1.0;
+      break;
+    case BIMODAL:
+      increments[i] = uniform_generator() < 0.9 ?
+	0.1 * uniform_generator() : 10.0 * uniform_generator();
+      break;
+    }
+  }
+  next_increment = 0;
+}
+
+static void
+benchmark_hold(Distribution distribution, int list_size)
+{
+  Simulation_Run_Ptr simulation_run;
+  char parameters[64];
+  long int i;
+
+  random_generator_initialize(400072132);
+  make_increments(distribution);
+
+  simulation_run = simulation_run_new();
+  for (i=0; i<list_size; i++) hold_event(simulation_run, NULL);
+
+  benchmark_start();
+  for (i=0; i<operations; i++) simulation_run_execute_event(simulation_run);
+
+  sprintf(parameters, "%s, %d", distribution_names[distribution], list_size);
+  benchmark_report("schedule+execute", parameters, operations);
+
+  simulation_run_free_memory(simulation_run);
+}
+
+/*
+ * Deschedule a random pending event, and schedule another in its place.
+ */
+
+static void
+benchmark_deschedule(int list_size)
+{
+  Simulation_Run_Ptr simulation_run;
+  char parameters[64];
+  long int * ids, i;
+  Event event;
+  int k;
+
+  random_generator_initialize(400072132);
+  make_increments(EXPONENTIAL);
+
+  event.description = "Hold";
+  event.function = hold_event;
+  event.attachment = NULL;
+
+  simulation_run = simulation_run_new();
+  ids = (long int *) malloc(list_size * sizeof(long int));
+  for (k=0; k<list_size; k++)
+    ids[k] = simulation_run_schedule_event(simulation_run, event,
+					   increments[k & (INCREMENTS - 1)]);
+
+  benchmark_start();
+  for (i=0; i<operations; i++) {
+    k = (int) (increments[i & (INCREMENTS - 1)] * 1e6) % list_size;
+    simulation_run_deschedule_event(simulation_run, ids[k]);
+    ids[k] = simulation_run_schedule_event(simulation_run, event,
+	       increments[(i + list_size) & (INCREMENTS - 1)]);
+  }
+
+  sprintf(parameters, "%d", list_size);
+  benchmark_report("deschedule+schedule", parameters, operations);
+
+  free(ids);
+  simulation_run_free_memory(simulation_run);
+}
+
+/*******************************************************************************/
+
+static void
+benchmark_fifoqueue(int queue_size)
+{
+  Fifoqueue_Ptr queue;
+  char parameters[64];
+  long int i;
+  int dummy;
+
+  queue = fifoqueue_new();
+  for (i=0; i<queue_size; i++) fifoqueue_put(queue, (void *) &dummy);
+
+  benchmark_start();
+  for (i=0; i<operations; i++) {
+    fifoqueue_put(queue, (void *) &dummy);
+    fifoqueue_get(queue);
+  }
+
+  sprintf(parameters, "%d", queue_size);
+  benchmark_report("fifoqueue_put+get", parameters, operations);
+
+  while (fifoqueue_size(queue) > 0) fifoqueue_get(queue);
+  fifoqueue_free(queue);
+}
+
+static void
+benchmark_server(void)
+{
+  Server_Ptr server;
+  long int i;
+  int dummy;
+
+  server = server_new();
+
+  benchmark_start();
+  for (i=0; i<operations; i++) {
+    server_put(server, (void *) &dummy);
+    server_get(server);
+  }
+  benchmark_report("server_put+get", "", operations);
+
+  server_free(server);
+}
+
+/*******************************************************************************/
+
+/* Keep the generated values alive so the loops aren't optimized away. */
+static volatile double sink;
+
+static void
+benchmark_generators(void)
+{
+  Rand_Stream_Ptr stream;
+  double sum;
+  long int i;
+
+  random_generator_initialize(400072132);
+  stream = rand_stream_new(400072132);
+
+  sum = 0.0;
+  benchmark_start();
+  for (i=0; i<operations; i++) sum += uniform_generator();
+  benchmark_report("uniform_generator", "", operations);
+  sink = sum;
+
+  sum = 0.0;
+  benchmark_start();
+  for (i=0; i<operations; i++) sum += exponential_generator(1.0);
+  benchmark_report("exponential_generator", "", operations);
+  sink = sum;
+
+  sum = 0.0;
+  benchmark_start();
+  for (i=0; i<operations; i++) sum += rand_stream_get(stream);
+  benchmark_report("rand_stream_get", "", operations);
+  sink = sum;
+
+  sum = 0.0;
+  benchmark_start();
+  for (i=0; i<operations; i++) sum += rand_stream_uniform_generator(stream);
+  benchmark_report("rand_stream_uniform", "", operations);
+  sink = sum;
+
+  sum = 0.0;
+  benchmark_start();
+  for (i=0; i<operations; i++)
+    sum += rand_stream_exponential_generator(stream, 1.0);
+  benchmark_report("rand_stream_exponential", "", operations);
+  sink = sum;
+
+  xfree(stream);
+}
+
+/*******************************************************************************/
+
+int
+main(int argc, char * argv[])
+{
+  static const int list_sizes[] = {1, 16, 256, 4096};
+  int d, i;
+
+  if (argc > 1) operations = atol(argv[1]);
+  if (operations <= 0) {
+    fprintf(stderr, "Usage: simlib_bench [operations]\n");
+    return 1;
+  }
+
+  printf("%-26s %-22s %10s %12s\n", "benchmark", "parameters", "ns/op",
+	 "allocs/op");
+
+  for (d=EXPONENTIAL; d<=BIMODAL; d++) {
+    for (i=0; i<(int) (sizeof(list_sizes)/sizeof(list_sizes[0])); i++) {
+      benchmark_hold((Distribution) d, list_sizes[i]);
+    }
+  }
+
+  for (i=0; i<(int) (sizeof(list_sizes)/sizeof(list_sizes[0])); i++) {
+    benchmark_deschedule(list_sizes[i]);
+  }
+
+  benchmark_fifoqueue(0);
+  benchmark_fifoqueue(1000);
+  benchmark_server();
+  benchmark_generators();
+
+  return 0;
+}
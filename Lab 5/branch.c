@@ -0,0 +1,207 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "simparameters.h"
+#include "main.h"
+#include "output.h"
+#include "statistics.h"
+#include "fifoqueue_spill.h"
+#include "random_streams.h"
+#include "branch.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * Make a forked child's copy of a simulation_run its own, and continue it
+ * with new random numbers from seed. The packet export, live metrics and
+ * progress reports belong to the parent, whose threads fork() doesn't copy,
+ * and so do the event trace and the spill files of the queues, which fork()
+ * shares.
+ */
+
+void
+branch_detach(Simulation_Run_Ptr simulation_run, unsigned seed)
+{
+  Simulation_Run_Data_Ptr data;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  data->packet_export = NULL;
+  data->metrics = NULL;
+  data->progress = NULL;
+  simulation_run_set_trace(simulation_run, NULL);
+
+  random_generator_initialize(seed);
+  random_streams_initialize(simulation_run, seed, data->antithetic);
+  event_source_flush(data->arrival_source);
+  data->random_seed = seed;
+
+#if QUEUE_SPILL_SEGMENT > 0
+  {
+    int i;
+
+    for (i=0; i<NUMBER_OF_STATIONS; i++)
+      if ((data->stations+i)->buffer->spill != NULL)
+	fifoqueue_spill_reopen((data->stations+i)->buffer);
+    if (data->cloud_server_queue->spill != NULL)
+      fifoqueue_spill_reopen(data->cloud_server_queue);
+  }
+#endif
+}
+
+/*
+ * The mean backoff of the branch for the k-th seed (from 0), from
+ * BRANCH_BACKOFF_LIST, or 0 to keep the current one.
+ */
+
+static double
+branch_mean_backoff(int k)
+{
+  double BRANCH_BACKOFFS[] = {BRANCH_BACKOFF_LIST};
+  int backoffs = (int) (sizeof(BRANCH_BACKOFFS)/sizeof(double));
+
+  return k < backoffs ? BRANCH_BACKOFFS[k] : 0.0;
+}
+
+/*
+ * Start a branch from the warmed-up state: discard the warm-up statistics
+ * and memory accounts, and change the mean backoff if the branch has its own.
+ */
+
+static void
+branch_start(Simulation_Run_Ptr simulation_run, int k)
+{
+  Simulation_Run_Data_Ptr data;
+  double mean_backoff;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  statistics_reset(simulation_run);
+  memory_usage_reset();
+
+  if ((mean_backoff = branch_mean_backoff(k)) > 0.0) {
+    data->mean_backoff_duration = mean_backoff;
+    printf("Branch %d (seed %u): mean backoff %g\n", k, data->random_seed,
+	   mean_backoff);
+  }
+}
+
+/*
+ * Branch a warmed-up simulation_run into one child process per seed in
+ * BRANCH_SEED_LIST. Each child inherits the parent's state copy-on-write,
+ * reseeds the random number generator, discards the warm-up statistics,
+ * takes up its mean backoff from BRANCH_BACKOFF_LIST, if any, and then runs
+ * for RUNLENGTH more processed packets before printing its results and
+ * exiting. The parent waits for all of its children and returns with its own
+ * state untouched, so the caller only has to clean it up.
+ */
+
+void
+branch_from_warm_state(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  unsigned branch_seed;
+  unsigned BRANCH_SEEDS[] = {BRANCH_SEED_LIST, 0};
+  int j=0;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  printf("\nWarm-up done at time %.1f (seed %d). Branching ...\n",
+	 simulation_run_get_time(simulation_run), data->random_seed);
+
+#ifndef _WIN32
+
+  {
+    pid_t pid;
+    int status;
+    int children = 0;
+
+    while ((branch_seed = BRANCH_SEEDS[j++]) != 0) {
+
+      /* Don't let the children inherit (and repeat) buffered output. */
+      fflush(stdout);
+
+      if ((pid = fork()) < 0) {
+	perror("fork");
+	break;
+      }
+
+      if (pid == 0) {
+	/* Child: continue from the shared warmed state with a new seed. */
+	branch_detach(simulation_run, branch_seed);
+	branch_start(simulation_run, j-1);
+
+	data->metrics = output_open_metrics(branch_seed);
+	data->progress = progress_start(simulation_run, 1);
+
+	while(run_in_progress(simulation_run)) {
+	  simulation_run_execute_event(simulation_run);
+	}
+	progress_stop(data->progress);
+
+	output_results(simulation_run);
+	if (data->metrics != NULL) {
+	  metrics_publish(data->metrics, simulation_run);
+	  metrics_close(data->metrics);
+	}
+	fflush(stdout);
+	_exit(0);
+      }
+      children++;
+    }
+
+    /* Parent: wait for the branches to finish. */
+    while (children > 0 && wait(&status) > 0) children--;
+  }
+
+#else /* _WIN32 */
+
+  /* There is no fork() here, so the branches are simulated one after the
+     other, each continuing where the previous one stopped. */
+  while ((branch_seed = BRANCH_SEEDS[j++]) != 0) {
+    random_generator_initialize(branch_seed);
+    random_streams_initialize(simulation_run, branch_seed, data->antithetic);
+    event_source_flush(data->arrival_source);
+    data->random_seed = branch_seed;
+    branch_start(simulation_run, j-1);
+    data->progress = progress_start(simulation_run, 0);
+
+    while(run_in_progress(simulation_run)) {
+      simulation_run_execute_event(simulation_run);
+    }
+    progress_stop(data->progress);
+    output_results(simulation_run);
+  }
+
+#endif /* _WIN32 */
+}
+
@@ -26,6 +26,7 @@
 #include "simparameters.h"
 #include "main.h"
 #include "channel.h"
+#include "probes.h"
 
 /*******************************************************************************/
 
@@ -41,11 +42,32 @@ channel_new()
   Channel_Ptr new_channel;
 
   new_channel = (Channel_Ptr) xmalloc(sizeof(Channel));
+  new_channel->busy = NULL;
+  new_channel->collision = NULL;
+  new_channel->state = IDLE;
   set_channel_state(new_channel, IDLE);
   reset_transmitting_stn_count(new_channel);
   return new_channel;
 }
 
+void
+channel_track_utilization(Channel_Ptr channel,
+			  Simulation_Run_Ptr simulation_run)
+{
+  channel->busy = time_average_new(simulation_run,
+		    channel->state != IDLE ? 1.0 : 0.0);
+  channel->collision = time_average_new(simulation_run,
+			 channel->state == COLLISION ? 1.0 : 0.0);
+}
+
+void
+channel_free(Channel_Ptr channel)
+{
+  if (channel->busy != NULL) xfree(channel->busy);
+  if (channel->collision != NULL) xfree(channel->collision);
+  xfree(channel);
+}
+
 Channel_State
 get_channel_state(Channel_Ptr channel)
 {
@@ -55,7 +77,13 @@ get_channel_state(Channel_Ptr channel)
 void
 set_channel_state(Channel_Ptr channel, Channel_State state)
 {
+  PROBE3(aloha, channel__state, channel, (int) channel->state, (int) state);
   channel->state = state;
+
+  if (channel->busy != NULL) {
+    time_average_set(channel->busy, state != IDLE ? 1.0 : 0.0);
+    time_average_set(channel->collision, state == COLLISION ? 1.0 : 0.0);
+  }
 }
 
 int
@@ -37,10 +37,17 @@
 
 typedef enum {IDLE, SUCCESS, COLLISION} Channel_State;
 
+/*
+ * If busy is not NULL, the fractions of time that the channel is not IDLE,
+ * and that it is in COLLISION, are tracked.
+ */
+
 typedef struct _channel_
 {
   Channel_State state;
   int transmitting_stn_count;
+  Time_Average_Ptr busy;
+  Time_Average_Ptr collision;
 } Channel, * Channel_Ptr;
 
 /**********************************************************************/
@@ -52,6 +59,12 @@ typedef struct _channel_
 Channel_Ptr
 channel_new(void);
 
+void
+channel_track_utilization(Channel_Ptr, Simulation_Run_Ptr);
+
+void
+channel_free(Channel_Ptr);
+
 Channel_State
 get_channel_state(Channel_Ptr);
 
@@ -0,0 +1,640 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "simparameters.h"
+#include "main.h"
+#include "packet_arrival.h"
+#include "packet_transmission.h"
+#include "checkpoint.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * A checkpoint holds everything needed to continue a simulation_run: the
+ * clock, the number of events executed, the event list, the simulation_run data (including all stations),
+ * the channel, the contents of the station buffers, the cloud server and its
+ * queue, their time averages, the event sources, and the random number
+ * generator state. Structures without pointers are written raw. Pointers are
+ * never written. Packets are written in buffer order, and events refer to
+ * them by station and buffer position.
+ */
+
+#define CHECKPOINT_MAGIC "ALOHACKP"
+
+typedef struct _checkpoint_header_
+{
+  char magic[8];
+  unsigned version;
+  unsigned number_of_stations;
+  unsigned data_size;
+  unsigned station_size;
+  unsigned packet_size;
+  unsigned channel_size;
+} Checkpoint_Header;
+
+/* How an event attachment is found again on restore. */
+typedef enum {NO_ATTACHMENT, CLOUD_SERVER_ATTACHMENT,
+	      STATION_PACKET_ATTACHMENT} Attachment_Kind;
+
+typedef struct _checkpoint_event_
+{
+  double occurrence_time;
+  long int event_id;
+  int type;
+  int attachment_kind;
+  int station_id;
+  int position;
+} Checkpoint_Event;
+
+/* Event sources are written in the order they were added, each followed by
+   its block of pre-generated intervals. */
+typedef struct _checkpoint_source_
+{
+  double occurrence_time;
+  long int event_id;
+  int type;
+  int active;
+  int block_size;
+  int next_interval;
+} Checkpoint_Source;
+
+/*
+ * All event types that can be on the event list. The descriptions must match
+ * the ones used by the corresponding schedule functions.
+ */
+
+static const struct
+{
+  void (* function)(Simulation_Run_Ptr, void *);
+  const char * description;
+} event_types[] = {
+  {packet_arrival_event, "Packet Arrival"},
+  {transmission_start_event, "Start Of Packet"},
+  {transmission_end_event, "End of Packet"},
+  {end_packet_processing_event, "Packet Processing End"},
+};
+
+#define NUMBER_OF_EVENT_TYPES ((int) (sizeof(event_types)/sizeof(event_types[0])))
+
+/*******************************************************************************/
+
+static volatile sig_atomic_t checkpoint_requested = 0;
+
+#ifndef _WIN32
+static pid_t checkpoint_writer = 0;
+
+static void
+checkpoint_signal_handler(int signal_number)
+{
+  (void) signal_number;
+  checkpoint_requested = 1;
+}
+#endif
+
+static void
+checkpoint_file_name(char * name, Simulation_Run_Data_Ptr data)
+{
+  sprintf(name, CHECKPOINT_FILE, data->random_seed);
+  if (data->antithetic) strcat(name, ".antithetic");
+}
+
+/*
+ * Set up periodic checkpointing for a new simulation_run. On POSIX systems a
+ * checkpoint can also be requested at any time by sending SIGUSR1.
+ */
+
+void
+checkpoint_initialize(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  data->next_checkpoint = CHECKPOINT_INTERVAL;
+  checkpoint_requested = 0;
+
+#ifndef _WIN32
+  signal(SIGUSR1, checkpoint_signal_handler);
+#endif
+}
+
+/*
+ * Called after each event. Take a checkpoint if one is due.
+ */
+
+void
+checkpoint_poll(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  if (checkpoint_requested ||
+      (CHECKPOINT_INTERVAL > 0 &&
+       data->packets_processed >= data->next_checkpoint)) {
+
+    checkpoint_requested = 0;
+    while (data->next_checkpoint <= data->packets_processed)
+      data->next_checkpoint += CHECKPOINT_INTERVAL;
+
+    checkpoint_save(simulation_run);
+  }
+}
+
+/*
+ * Write a checkpoint file for the simulation_run. On POSIX systems the state
+ * is written by a forked child from its copy-on-write image of the process,
+ * so the simulation only pauses for the fork itself. The file is written
+ * under a temporary name and renamed when complete, so a crash part way
+ * through never leaves a truncated checkpoint behind.
+ */
+
+void
+checkpoint_save(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  char name[FILENAME_MAX], temp_name[FILENAME_MAX + 8];
+  FILE * fp;
+  int written;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  checkpoint_file_name(name, data);
+  sprintf(temp_name, "%s.tmp", name);
+
+#ifndef _WIN32
+  /* Spilled queues are in files that fork() shares rather than copies, so
+     with them the checkpoint is written here and now. */
+  if (QUEUE_SPILL_SEGMENT == 0) {
+    /* Don't pile up writers if the last one hasn't finished yet. */
+    if (checkpoint_writer > 0) {
+      if (waitpid(checkpoint_writer, NULL, WNOHANG) == 0) return;
+      checkpoint_writer = 0;
+    }
+
+    fflush(stdout);
+    if ((checkpoint_writer = fork()) < 0) {
+      perror("fork");
+      checkpoint_writer = 0;
+      return;
+    }
+    if (checkpoint_writer > 0) return;
+  }
+#endif
+
+  if ((fp = fopen(temp_name, "wb")) == NULL) {
+    printf("Warning: Cannot write checkpoint file %s\n", temp_name);
+  } else {
+    written = checkpoint_write(simulation_run, fp) == 0;
+    if (fclose(fp) == 0 && written) {
+      remove(name);
+      rename(temp_name, name);
+    } else {
+      printf("Warning: Writing checkpoint file %s failed\n", temp_name);
+      remove(temp_name);
+    }
+  }
+
+#ifndef _WIN32
+  if (QUEUE_SPILL_SEGMENT == 0) _exit(0);
+#endif
+}
+
+/*******************************************************************************/
+
+static int
+write_time_average(Time_Average_Ptr time_average, FILE * fp)
+{
+  int present;
+
+  present = time_average != NULL;
+  if (fwrite(&present, sizeof(present), 1, fp) != 1) return -1;
+  if (present && fwrite(time_average, sizeof(Time_Average), 1, fp) != 1)
+    return -1;
+  return 0;
+}
+
+static int
+write_packet(void * packet, void * fp)
+{
+  return fwrite(packet, sizeof(Packet), 1, (FILE *) fp) != 1 ? -1 : 0;
+}
+
+static int
+write_packets(Fifoqueue_Ptr queue, FILE * fp)
+{
+  int count;
+
+  count = fifoqueue_size(queue);
+  if (fwrite(&count, sizeof(count), 1, fp) != 1) return -1;
+
+  if (fifoqueue_visit(queue, write_packet, (void *) fp) != 0) return -1;
+  return write_time_average(queue->occupancy, fp);
+}
+
+/*
+ * Find the position of a packet in a queue. The visit stops at the packet.
+ */
+
+typedef struct _packet_search_
+{
+  void * packet;
+  int position;
+} Packet_Search;
+
+static int
+find_packet(void * packet, void * search)
+{
+  if (packet == ((Packet_Search *) search)->packet) return 1;
+  ((Packet_Search *) search)->position++;
+  return 0;
+}
+
+static int
+event_type(Event * event)
+{
+  int i;
+
+  for (i=0; i<NUMBER_OF_EVENT_TYPES; i++) {
+    if (event_types[i].function == event->function) return i;
+  }
+  return -1;
+}
+
+/*
+ * Write the complete state of a simulation_run to an open file. Returns 0 on
+ * success.
+ */
+
+int
+checkpoint_write(Simulation_Run_Ptr simulation_run, FILE * fp)
+{
+  Simulation_Run_Data_Ptr data;
+  Checkpoint_Header header;
+  Checkpoint_Event record;
+  Checkpoint_Source source_record;
+  Event_Container_Ptr event;
+  Event_Source_Ptr source;
+  Packet_Search search;
+  Packet_Ptr packet;
+  double now;
+  unsigned random_seed;
+  unsigned long random_draws;
+  int i, busy, found;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.version = CHECKPOINT_VERSION;
+  header.number_of_stations = NUMBER_OF_STATIONS;
+  header.data_size = sizeof(Simulation_Run_Data);
+  header.station_size = sizeof(Station);
+  header.packet_size = sizeof(Packet);
+  header.channel_size = sizeof(Channel);
+  if (fwrite(&header, sizeof(header), 1, fp) != 1) return -1;
+
+  /* Clock, event count and random number generator. */
+  now = simulation_run_get_time(simulation_run);
+  random_generator_get_state(&random_seed, &random_draws);
+  if (fwrite(&now, sizeof(now), 1, fp) != 1 ||
+      fwrite(&simulation_run->events_executed,
+	     sizeof(simulation_run->events_executed), 1, fp) != 1 ||
+      fwrite(&random_seed, sizeof(random_seed), 1, fp) != 1 ||
+      fwrite(&random_draws, sizeof(random_draws), 1, fp) != 1) return -1;
+
+  /* Simulation_Run data, stations and channel. */
+  if (fwrite(data, sizeof(Simulation_Run_Data), 1, fp) != 1 ||
+      fwrite(data->stations, sizeof(Station), NUMBER_OF_STATIONS, fp) !=
+      NUMBER_OF_STATIONS ||
+      fwrite(data->channel, sizeof(Channel), 1, fp) != 1) return -1;
+
+  /* Packets in the station buffers, the cloud server and its queue. */
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    if (write_packets((data->stations+i)->buffer, fp) != 0) return -1;
+  }
+
+  busy = server_state(data->cloud_server) == BUSY;
+  if (fwrite(&busy, sizeof(busy), 1, fp) != 1) return -1;
+  if (busy && fwrite(data->cloud_server->customer_in_service, sizeof(Packet),
+		     1, fp) != 1) return -1;
+  if (write_time_average(data->cloud_server->utilization, fp) != 0 ||
+      write_time_average(data->channel->busy, fp) != 0 ||
+      write_time_average(data->channel->collision, fp) != 0) return -1;
+
+  if (write_packets(data->cloud_server_queue, fp) != 0) return -1;
+
+  /* The event list, in occurrence order. */
+  if (fwrite(&simulation_run->eventlist->size, sizeof(int), 1, fp) != 1)
+    return -1;
+
+  for (event = simulation_run->eventlist->front_ptr; event != NULL;
+       event = event->next_container) {
+
+    memset(&record, 0, sizeof(record));
+    record.occurrence_time = event->occurrence_time;
+    record.event_id = event->event_id;
+
+    if ((record.type = event_type(&event->event)) < 0) {
+      printf("Error: Cannot checkpoint event \"%s\"\n",
+	     event->event.description);
+      return -1;
+    }
+
+    if (event->event.attachment == NULL) {
+      record.attachment_kind = NO_ATTACHMENT;
+    } else if (event->event.attachment == (void *) data->cloud_server) {
+      record.attachment_kind = CLOUD_SERVER_ATTACHMENT;
+    } else {
+      /* A packet, which is always in its station buffer. */
+      packet = (Packet_Ptr) event->event.attachment;
+      record.attachment_kind = STATION_PACKET_ATTACHMENT;
+      record.station_id = packet->station_id;
+      search.packet = (void *) packet;
+      search.position = 0;
+      found = fifoqueue_visit((data->stations + packet->station_id)->buffer,
+			      find_packet, (void *) &search);
+      record.position = search.position;
+
+      if (!found) {
+	printf("Error: Cannot find packet of event \"%s\"\n",
+	       event->event.description);
+	return -1;
+      }
+    }
+    if (fwrite(&record, sizeof(record), 1, fp) != 1) return -1;
+  }
+
+  /* The event sources. */
+  for (source = simulation_run->eventlist->sources; source != NULL;
+       source = source->next_source) {
+
+    memset(&source_record, 0, sizeof(source_record));
+    source_record.occurrence_time = source->occurrence_time;
+    source_record.event_id = source->event_id;
+    source_record.active = source->active;
+    source_record.block_size = source->block_size;
+    source_record.next_interval = source->next_interval;
+
+    if ((source_record.type = event_type(&source->event)) < 0) {
+      printf("Error: Cannot checkpoint event \"%s\"\n",
+	     source->event.description);
+      return -1;
+    }
+    if (fwrite(&source_record, sizeof(source_record), 1, fp) != 1 ||
+	(source->block_size > 0 &&
+	 fwrite(source->intervals, sizeof(double), source->block_size, fp) !=
+	 (size_t) source->block_size)) return -1;
+  }
+
+  return 0;
+}
+
+/*******************************************************************************/
+
+static void
+read_or_exit(void * ptr, size_t size, size_t count, FILE * fp)
+{
+  if (fread(ptr, size, count, fp) != count) {
+    printf("Error: Checkpoint file is truncated.\n");
+    exit(1);
+  }
+}
+
+static Packet_Ptr
+read_packet(FILE * fp)
+{
+  Packet_Ptr packet;
+
+  packet = (Packet_Ptr) xmalloc_tagged(sizeof(Packet), MEMORY_PACKETS);
+  read_or_exit(packet, sizeof(Packet), 1, fp);
+  return packet;
+}
+
+/*
+ * Read a time average into an existing one, keeping its clock.
+ */
+
+static void
+read_time_average(Time_Average_Ptr time_average, FILE * fp)
+{
+  Time_Average saved;
+  int present;
+
+  read_or_exit(&present, sizeof(present), 1, fp);
+  if (!present) return;
+
+  read_or_exit(&saved, sizeof(saved), 1, fp);
+  if (time_average != NULL) {
+    saved.clock = time_average->clock;
+    *time_average = saved;
+  }
+}
+
+static void
+read_packets(Fifoqueue_Ptr queue, FILE * fp)
+{
+  int count;
+
+  read_or_exit(&count, sizeof(count), 1, fp);
+  while (count-- > 0) fifoqueue_put(queue, (void *) read_packet(fp));
+  read_time_average(queue->occupancy, fp);
+}
+
+/*
+ * Restore a simulation_run from an open checkpoint file. The simulation_run
+ * must be freshly created and initialized by main(), with nothing scheduled
+ * yet. The program exits if the file doesn't match this build.
+ */
+
+void
+checkpoint_restore(Simulation_Run_Ptr simulation_run, FILE * fp)
+{
+  Simulation_Run_Data_Ptr data;
+  Simulation_Run_Data saved_data;
+  Checkpoint_Header header;
+  Checkpoint_Event record;
+  Checkpoint_Source source_record;
+  Event_Source_Ptr source;
+  Station_Ptr stations;
+  Channel saved_channel;
+  Buffer_Ptr buffer;
+  Queue_Container_Ptr container;
+  Event event;
+  double now;
+  unsigned random_seed;
+  unsigned long random_draws;
+  int i, busy, number_of_events;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  read_or_exit(&header, sizeof(header), 1, fp);
+
+  if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != CHECKPOINT_VERSION ||
+      header.number_of_stations != NUMBER_OF_STATIONS ||
+      header.data_size != sizeof(Simulation_Run_Data) ||
+      header.station_size != sizeof(Station) ||
+      header.packet_size != sizeof(Packet) ||
+      header.channel_size != sizeof(Channel)) {
+    printf("Error: Checkpoint file does not match this simulation.\n");
+    exit(1);
+  }
+
+  read_or_exit(&now, sizeof(now), 1, fp);
+  read_or_exit(&simulation_run->events_executed,
+	       sizeof(simulation_run->events_executed), 1, fp);
+  read_or_exit(&random_seed, sizeof(random_seed), 1, fp);
+  read_or_exit(&random_draws, sizeof(random_draws), 1, fp);
+
+  simulation_run_restore_time(simulation_run, now);
+  random_generator_restore(random_seed, random_draws);
+
+  /* Read the data over the fresh one, keeping the fresh pointers. */
+  saved_data = *data;
+  read_or_exit(data, sizeof(Simulation_Run_Data), 1, fp);
+  data->stations = saved_data.stations;
+  data->channel = saved_data.channel;
+  data->cloud_server_queue = saved_data.cloud_server_queue;
+  data->cloud_server = saved_data.cloud_server;
+  data->packet_export = saved_data.packet_export;
+  data->metrics = saved_data.metrics;
+  data->arrival_source = saved_data.arrival_source;
+  data->progress = saved_data.progress;
+  data->arrival_traces = saved_data.arrival_traces;
+
+  stations = data->stations;
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    buffer = (stations+i)->buffer;
+    read_or_exit(stations+i, sizeof(Station), 1, fp);
+    (stations+i)->buffer = buffer;
+  }
+  saved_channel = *data->channel;
+  read_or_exit(data->channel, sizeof(Channel), 1, fp);
+  data->channel->busy = saved_channel.busy;
+  data->channel->collision = saved_channel.collision;
+
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    read_packets((stations+i)->buffer, fp);
+  }
+
+  read_or_exit(&busy, sizeof(busy), 1, fp);
+  if (busy) server_put(data->cloud_server, (void *) read_packet(fp));
+  read_time_average(data->cloud_server->utilization, fp);
+  read_time_average(data->channel->busy, fp);
+  read_time_average(data->channel->collision, fp);
+
+  read_packets(data->cloud_server_queue, fp);
+
+  read_or_exit(&number_of_events, sizeof(number_of_events), 1, fp);
+
+  while (number_of_events-- > 0) {
+    read_or_exit(&record, sizeof(record), 1, fp);
+
+    if (record.type < 0 || record.type >= NUMBER_OF_EVENT_TYPES) {
+      printf("Error: Unknown event type in checkpoint file.\n");
+      exit(1);
+    }
+    event.function = event_types[record.type].function;
+    event.description = event_types[record.type].description;
+
+    switch (record.attachment_kind) {
+    case NO_ATTACHMENT:
+      event.attachment = NULL;
+      break;
+    case CLOUD_SERVER_ATTACHMENT:
+      event.attachment = (void *) data->cloud_server;
+      break;
+    default:
+      /* Packets with events are at the head, which is never spilled. */
+      container = (stations + record.station_id)->buffer->front_ptr;
+      for (i=0; i<record.position && container != NULL; i++)
+	container = container->next_ptr;
+      if (container == NULL) {
+	printf("Error: Checkpoint event packet is not in its buffer.\n");
+	exit(1);
+      }
+      event.attachment = container->content_ptr;
+      break;
+    }
+
+    simulation_run_restore_event(simulation_run, event,
+				 record.occurrence_time, record.event_id);
+  }
+
+  /* The fresh simulation_run has the same sources, in the same order. */
+  for (source = simulation_run->eventlist->sources; source != NULL;
+       source = source->next_source) {
+    read_or_exit(&source_record, sizeof(source_record), 1, fp);
+
+    if (source_record.type < 0 || source_record.type >= NUMBER_OF_EVENT_TYPES ||
+	event_types[source_record.type].function != source->event.function ||
+	source_record.block_size != source->block_size) {
+      printf("Error: Event sources in checkpoint file do not match.\n");
+      exit(1);
+    }
+    if (source->block_size > 0)
+      read_or_exit(source->intervals, sizeof(double), source->block_size, fp);
+    source->next_interval = source_record.next_interval;
+
+    if (source_record.active)
+      simulation_run_restore_source(simulation_run, source,
+				    source_record.occurrence_time,
+				    source_record.event_id);
+  }
+}
+
+/*
+ * Restore the simulation_run from its checkpoint file, if there is one.
+ * Returns 1 if the simulation_run was restored and 0 if there was no
+ * checkpoint to restore from.
+ */
+
+int
+checkpoint_restore_file(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  char name[FILENAME_MAX];
+  FILE * fp;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  checkpoint_file_name(name, data);
+
+  if ((fp = fopen(name, "rb")) == NULL) return 0;
+
+  checkpoint_restore(simulation_run, fp);
+  fclose(fp);
+
+  printf("Restored from checkpoint %s at time %.1f\n", name,
+	 simulation_run_get_time(simulation_run));
+  return 1;
+}
+
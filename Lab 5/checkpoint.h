@@ -0,0 +1,70 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include "main.h"
+
+/*******************************************************************************/
+
+/*
+ * Checkpoint file format version. Bump this whenever the layout of the file
+ * changes. Size changes of the structures written raw into it are caught by
+ * the size checks in the header.
+ */
+
+#define CHECKPOINT_VERSION 4
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+checkpoint_initialize(Simulation_Run_Ptr);
+
+void
+checkpoint_poll(Simulation_Run_Ptr);
+
+void
+checkpoint_save(Simulation_Run_Ptr);
+
+int
+checkpoint_write(Simulation_Run_Ptr, FILE *);
+
+void
+checkpoint_restore(Simulation_Run_Ptr, FILE *);
+
+int
+checkpoint_restore_file(Simulation_Run_Ptr);
+
+/*******************************************************************************/
+
+#endif /* checkpoint.h */
+
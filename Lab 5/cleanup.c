@@ -33,20 +33,47 @@ void
 cleanup (Simulation_Run_Ptr simulation_run)
 {
   Simulation_Run_Data_Ptr data;
+  Arrival_Trace_Ptr trace;
   int i;
 
   data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
 
+  /* Publish the final state before it goes away. */
+  if (data->metrics != NULL) {
+    metrics_publish(data->metrics, simulation_run);
+    metrics_close(data->metrics);
+  }
+
   /* Clean out the stations. */
   for(i=0; i<NUMBER_OF_STATIONS; i++) {
     while (fifoqueue_size((data->stations+i)->buffer) > 0) {
       xfree(fifoqueue_get((data->stations+i)->buffer));
     }
+    fifoqueue_free((data->stations+i)->buffer);
   }
   xfree(data->stations);
 
+  /* Clean out the cloud server and its queue. */
+  while (fifoqueue_size(data->cloud_server_queue) > 0) {
+    xfree(fifoqueue_get(data->cloud_server_queue));
+  }
+  fifoqueue_free(data->cloud_server_queue);
+
+  if (server_state(data->cloud_server) == BUSY) {
+    xfree(server_get(data->cloud_server));
+  }
+  server_free(data->cloud_server);
+
   /* Clean out the channel. */
-  xfree(data->channel);
+  channel_free(data->channel);
+
+  if (data->packet_export != NULL) packet_export_close(data->packet_export);
+
+  while (data->arrival_traces != NULL) {
+    trace = data->arrival_traces;
+    data->arrival_traces = trace->next_trace;
+    arrival_trace_close(trace);
+  }
 
   /* Clean up the simulation_run. */
   simulation_run_free_memory(simulation_run);
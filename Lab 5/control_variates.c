@@ -0,0 +1,245 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <math.h>
+#include "control_variates.h"
+
+/*******************************************************************************/
+
+/*
+ * Controls whose batch means vary less than this, relative to their size,
+ * are taken to be constant.
+ */
+
+#define CONSTANT_CONTROL 1e-12
+
+/*******************************************************************************/
+
+void
+control_variates_initialize(Control_Variates_Ptr cv, long int batch_size,
+			    double * known_mean)
+{
+  int k;
+
+  for (k=0; k<CONTROLS; k++) {
+    cv->known_mean[k] = known_mean[k];
+    cv->control_sum[k] = 0.0;
+  }
+  cv->batch_size = batch_size;
+  cv->count = 0;
+  cv->sum = 0.0;
+  cv->number_of_batches = 0;
+}
+
+/*
+ * Add a delay with the packet's inputs. When all the batches are used,
+ * adjacent ones are merged.
+ */
+
+void
+control_variates_add(Control_Variates_Ptr cv, double delay, double * control)
+{
+  int i, k;
+
+  cv->sum += delay;
+  for (k=0; k<CONTROLS; k++) cv->control_sum[k] += control[k];
+
+  if (++cv->count < cv->batch_size) return;
+
+  cv->mean[cv->number_of_batches] = cv->sum/cv->count;
+  for (k=0; k<CONTROLS; k++) {
+    cv->control_mean[cv->number_of_batches][k] =
+      cv->control_sum[k]/cv->count;
+    cv->control_sum[k] = 0.0;
+  }
+  cv->number_of_batches++;
+  cv->count = 0;
+  cv->sum = 0.0;
+
+  if (cv->number_of_batches == CV_MAX_BATCHES) {
+    for (i=0; i<CV_MAX_BATCHES/2; i++) {
+      cv->mean[i] = (cv->mean[2*i] + cv->mean[2*i+1])/2;
+      for (k=0; k<CONTROLS; k++)
+	cv->control_mean[i][k] =
+	  (cv->control_mean[2*i][k] + cv->control_mean[2*i+1][k])/2;
+    }
+    cv->number_of_batches = CV_MAX_BATCHES/2;
+    cv->batch_size *= 2;
+  }
+}
+
+/*
+ * Invert the q x q matrix a in place (Gauss-Jordan with partial pivoting).
+ * Returns 0 if it is singular.
+ */
+
+static int
+invert(double a[CONTROLS][CONTROLS], int q)
+{
+  double inverse[CONTROLS][CONTROLS], factor, swap;
+  int i, j, r, pivot;
+
+  for (i=0; i<q; i++)
+    for (j=0; j<q; j++) inverse[i][j] = i == j;
+
+  for (i=0; i<q; i++) {
+    pivot = i;
+    for (r=i+1; r<q; r++) if (fabs(a[r][i]) > fabs(a[pivot][i])) pivot = r;
+    if (a[pivot][i] == 0.0) return 0;
+
+    for (j=0; j<q; j++) {
+      swap = a[i][j]; a[i][j] = a[pivot][j]; a[pivot][j] = swap;
+      swap = inverse[i][j]; inverse[i][j] = inverse[pivot][j];
+      inverse[pivot][j] = swap;
+    }
+
+    factor = a[i][i];
+    for (j=0; j<q; j++) {
+      a[i][j] /= factor;
+      inverse[i][j] /= factor;
+    }
+    for (r=0; r<q; r++) {
+      if (r == i) continue;
+      factor = a[r][i];
+      for (j=0; j<q; j++) {
+	a[r][j] -= factor*a[i][j];
+	inverse[r][j] -= factor*inverse[i][j];
+      }
+    }
+  }
+
+  for (i=0; i<q; i++)
+    for (j=0; j<q; j++) a[i][j] = inverse[i][j];
+  return 1;
+}
+
+/*
+ * The plain and the control-variate estimates of the mean delay, with 95%
+ * confidence intervals. With n batches and q controls in use, the adjusted
+ * estimate is y - beta'(x - mu), beta being the least squares slopes of the
+ * batch delays on the batch inputs, and its variance is
+ *
+ *   s^2 (1/n + (x - mu)' S^-1 (x - mu)),
+ *
+ * with S the inputs' centred sum of squares and s^2 the residual variance
+ * on n-q-1 degrees of freedom.
+ */
+
+Control_Variate_Estimate
+control_variates_estimate(Control_Variates_Ptr cv)
+{
+  Control_Variate_Estimate estimate;
+  double x_bar[CONTROLS], s[CONTROLS][CONTROLS], s_xy[CONTROLS];
+  double y_bar, dx[CONTROLS], dy, residual, sum_of_squares, quadratic;
+  int index[CONTROLS];
+  int n, q, i, j, k, b;
+
+  n = cv->number_of_batches;
+  estimate.plain = confidence_interval(cv->mean, n);
+  estimate.adjusted = estimate.plain;
+  for (k=0; k<CONTROLS; k++) {
+    estimate.used[k] = 0;
+    estimate.beta[k] = 0.0;
+  }
+  if (n < 2) return estimate;
+
+  y_bar = estimate.plain.mean;
+  for (k=0; k<CONTROLS; k++) {
+    x_bar[k] = 0.0;
+    for (b=0; b<n; b++) x_bar[k] += cv->control_mean[b][k];
+    x_bar[k] /= n;
+  }
+
+  /* Leave out the controls that didn't vary. */
+  q = 0;
+  for (k=0; k<CONTROLS; k++) {
+    sum_of_squares = 0.0;
+    for (b=0; b<n; b++)
+      sum_of_squares += (cv->control_mean[b][k] - x_bar[k]) *
+	(cv->control_mean[b][k] - x_bar[k]);
+    if (sum_of_squares > CONSTANT_CONTROL * (1.0 + x_bar[k]*x_bar[k]) * n)
+      index[q++] = k;
+  }
+
+  /* Keep enough degrees of freedom, and drop controls until the rest are
+     not collinear. */
+  while (q > 0 && n <= q+1) q--;
+  for (; q > 0; q--) {
+    for (i=0; i<q; i++) {
+      s_xy[i] = 0.0;
+      for (j=0; j<q; j++) s[i][j] = 0.0;
+    }
+    for (b=0; b<n; b++) {
+      dy = cv->mean[b] - y_bar;
+      for (i=0; i<q; i++) {
+	dx[i] = cv->control_mean[b][index[i]] - x_bar[index[i]];
+	s_xy[i] += dx[i]*dy;
+      }
+      for (i=0; i<q; i++)
+	for (j=0; j<q; j++) s[i][j] += dx[i]*dx[j];
+    }
+    if (invert(s, q)) break;
+  }
+  if (q == 0) return estimate;
+
+  for (i=0; i<q; i++) {
+    estimate.used[index[i]] = 1;
+    for (j=0; j<q; j++) estimate.beta[index[i]] += s[i][j]*s_xy[j];
+  }
+
+  /* The estimate, and the residual variance about the regression. */
+  estimate.adjusted.mean = y_bar;
+  for (i=0; i<q; i++) {
+    k = index[i];
+    dx[i] = x_bar[k] - cv->known_mean[k];
+    estimate.adjusted.mean -= estimate.beta[k]*dx[i];
+  }
+
+  sum_of_squares = 0.0;
+  for (b=0; b<n; b++) {
+    residual = cv->mean[b] - y_bar;
+    for (i=0; i<q; i++)
+      residual -= estimate.beta[index[i]] *
+	(cv->control_mean[b][index[i]] - x_bar[index[i]]);
+    sum_of_squares += residual*residual;
+  }
+
+  quadratic = 0.0;
+  for (i=0; i<q; i++)
+    for (j=0; j<q; j++) quadratic += dx[i]*s[i][j]*dx[j];
+
+  estimate.adjusted.half_width = student_t_quantile(n-q-1) *
+    sqrt(sum_of_squares/(n-q-1) * (1.0/n + quadratic));
+  return estimate;
+}
+
+const char *
+control_name(Control control)
+{
+  static const char * names[CONTROLS] =
+    {"interarrival", "upload", "service", "backoff"};
+
+  return names[control];
+}
+
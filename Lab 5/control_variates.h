@@ -0,0 +1,99 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _CONTROL_VARIATES_H_
+#define _CONTROL_VARIATES_H_
+
+/*******************************************************************************/
+
+#include "batch_means.h"
+
+/*******************************************************************************/
+
+/*
+ * Control-variate estimate of the mean delay. Each processed packet's delay
+ * is recorded with the packet's inputs, whose true means are known: the
+ * interarrival time before it, its upload time, its service time and the
+ * total excess of its backoffs over the mean backoff. These
+ * are averaged over batches, kept at most CV_MAX_BATCHES at a time like the
+ * batch means. At the end, the batch mean delays are regressed on the batch
+ * means of the inputs, and the delay estimate is corrected by how far the
+ * inputs were from their true means (Lavenberg and Welch).
+ *
+ * Inputs that did not vary, e.g., a fixed service time, are left out of the
+ * regression.
+ */
+
+#define CONTROLS 4
+#define CV_MAX_BATCHES 64
+
+typedef enum {
+  INTERARRIVAL_CONTROL,
+  UPLOAD_CONTROL,
+  SERVICE_CONTROL,
+  BACKOFF_CONTROL
+} Control;
+
+typedef struct _control_variates_
+{
+  double known_mean[CONTROLS];
+  long int batch_size;
+  long int count;
+  double sum;
+  double control_sum[CONTROLS];
+  int number_of_batches;
+  double mean[CV_MAX_BATCHES];
+  double control_mean[CV_MAX_BATCHES][CONTROLS];
+} Control_Variates, * Control_Variates_Ptr;
+
+typedef struct _control_variate_estimate_
+{
+  Confidence_Interval plain;
+  Confidence_Interval adjusted;
+  int used[CONTROLS];
+  double beta[CONTROLS];
+} Control_Variate_Estimate;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+control_variates_initialize(Control_Variates_Ptr, long int, double *);
+
+void
+control_variates_add(Control_Variates_Ptr, double, double *);
+
+Control_Variate_Estimate
+control_variates_estimate(Control_Variates_Ptr);
+
+const char *
+control_name(Control);
+
+/*******************************************************************************/
+
+#endif /* control_variates.h */
+
@@ -0,0 +1,151 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include "delay_stats.h"
+
+/*******************************************************************************/
+
+void
+delay_stats_initialize(Delay_Stats_Ptr stats)
+{
+  memset(stats, 0, sizeof(Delay_Stats));
+}
+
+/*
+ * Histogram bucket of a delay, and the smallest delay in a bucket.
+ */
+
+static int
+delay_bucket(double delay)
+{
+  int exponent, octave, sub_bucket;
+  double mantissa;
+
+  if (delay <= 0.0) return 0;
+
+  /* delay = mantissa * 2^exponent, with mantissa in [0.5, 1). */
+  mantissa = frexp(delay, &exponent);
+  octave = exponent - 1 - DELAY_HISTOGRAM_MIN_EXPONENT;
+
+  if (octave < 0) return 0;
+  if (octave >= DELAY_HISTOGRAM_OCTAVES) return DELAY_HISTOGRAM_BUCKETS - 1;
+
+  sub_bucket = (int) ((2.0*mantissa - 1.0) * DELAY_HISTOGRAM_SUB_BUCKETS);
+  return octave * DELAY_HISTOGRAM_SUB_BUCKETS + sub_bucket;
+}
+
+static double
+delay_bucket_start(int bucket)
+{
+  int octave, sub_bucket;
+
+  octave = bucket / DELAY_HISTOGRAM_SUB_BUCKETS;
+  sub_bucket = bucket % DELAY_HISTOGRAM_SUB_BUCKETS;
+  return ldexp(1.0 + (double) sub_bucket/DELAY_HISTOGRAM_SUB_BUCKETS,
+	       octave + DELAY_HISTOGRAM_MIN_EXPONENT);
+}
+
+void
+delay_stats_add(Delay_Stats_Ptr stats, double delay)
+{
+  double delta;
+
+  if (stats->count == 0 || delay < stats->min) stats->min = delay;
+  if (stats->count == 0 || delay > stats->max) stats->max = delay;
+
+  stats->count++;
+  delta = delay - stats->mean;
+  stats->mean += delta/stats->count;
+  stats->m2 += delta*(delay - stats->mean);
+
+  stats->histogram[delay_bucket(delay)]++;
+}
+
+/*
+ * Merge the statistics in source into destination (Chan et al.).
+ */
+
+void
+delay_stats_merge(Delay_Stats_Ptr destination, Delay_Stats_Ptr source)
+{
+  double delta;
+  long int count;
+  int i;
+
+  if (source->count == 0) return;
+  if (destination->count == 0) {
+    *destination = *source;
+    return;
+  }
+
+  count = destination->count + source->count;
+  delta = source->mean - destination->mean;
+
+  destination->m2 += source->m2 +
+    delta*delta*((double) destination->count*source->count/count);
+  destination->mean += delta*source->count/count;
+  destination->count = count;
+
+  if (source->min < destination->min) destination->min = source->min;
+  if (source->max > destination->max) destination->max = source->max;
+
+  for (i=0; i<DELAY_HISTOGRAM_BUCKETS; i++) {
+    destination->histogram[i] += source->histogram[i];
+  }
+}
+
+double
+delay_stats_variance(Delay_Stats_Ptr stats)
+{
+  return stats->count > 1 ? stats->m2/(stats->count - 1) : 0.0;
+}
+
+/*
+ * Estimate the q-quantile (0 < q < 1) as the middle of the histogram bucket
+ * it falls in, clipped to the observed range.
+ */
+
+double
+delay_stats_quantile(Delay_Stats_Ptr stats, double q)
+{
+  double target, cumulative = 0.0, estimate;
+  int i;
+
+  if (stats->count == 0) return 0.0;
+
+  target = q * stats->count;
+
+  for (i=0; i<DELAY_HISTOGRAM_BUCKETS-1; i++) {
+    cumulative += stats->histogram[i];
+    if (cumulative >= target) break;
+  }
+
+  estimate = (delay_bucket_start(i) + delay_bucket_start(i+1))/2;
+  if (estimate < stats->min) estimate = stats->min;
+  if (estimate > stats->max) estimate = stats->max;
+  return estimate;
+}
+
@@ -0,0 +1,86 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _DELAY_STATS_H_
+#define _DELAY_STATS_H_
+
+/*******************************************************************************/
+
+#include <stdint.h>
+
+/*******************************************************************************/
+
+/*
+ * Streaming delay statistics. The mean and variance are kept with Welford's
+ * method, and the distribution in a log-bucketed histogram: each power of two
+ * between 2^DELAY_HISTOGRAM_MIN_EXPONENT and 2^(DELAY_HISTOGRAM_MIN_EXPONENT +
+ * DELAY_HISTOGRAM_OCTAVES) is split into DELAY_HISTOGRAM_SUB_BUCKETS linear
+ * buckets, so quantiles are good to within 1/DELAY_HISTOGRAM_SUB_BUCKETS
+ * relative error. Delays outside the range go into the first or last bucket.
+ * Updates are O(1), the memory is fixed, and two Delay_Stats can be merged,
+ * e.g., to combine stations, seeds or threads. The buckets are 64 bits wide,
+ * so that they don't wrap in long runs or merges of many of them.
+ */
+
+#define DELAY_HISTOGRAM_SUB_BUCKETS 16
+#define DELAY_HISTOGRAM_OCTAVES 32
+#define DELAY_HISTOGRAM_MIN_EXPONENT -4
+#define DELAY_HISTOGRAM_BUCKETS \
+  (DELAY_HISTOGRAM_OCTAVES * DELAY_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct _delay_stats_
+{
+  long int count;
+  double mean;
+  double m2;
+  double min;
+  double max;
+  uint64_t histogram[DELAY_HISTOGRAM_BUCKETS];
+} Delay_Stats, * Delay_Stats_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+delay_stats_initialize(Delay_Stats_Ptr);
+
+void
+delay_stats_add(Delay_Stats_Ptr, double);
+
+void
+delay_stats_merge(Delay_Stats_Ptr, Delay_Stats_Ptr);
+
+double
+delay_stats_variance(Delay_Stats_Ptr);
+
+double
+delay_stats_quantile(Delay_Stats_Ptr, double);
+
+/*******************************************************************************/
+
+#endif /* delay_stats.h */
+
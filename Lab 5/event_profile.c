@@ -0,0 +1,242 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "simlib.h"
+#include "event_profile.h"
+
+/******************************************************************************/
+
+/*
+ * Create an empty profile.
+ */
+
+Event_Profile_Ptr
+event_profile_new(void)
+{
+  return (Event_Profile_Ptr) xcalloc(1, sizeof(Event_Profile));
+}
+
+/*
+ * The power-of-two bucket of a value: 0 holds 0, and bucket k > 0 holds
+ * values from 2^(k-1) up to 2^k - 1.
+ */
+
+static int
+event_profile_bucket(uint64_t value)
+{
+  int bucket = 0;
+
+  while (value > 0 && bucket < EVENT_PROFILE_BUCKETS - 1) {
+    value >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+/*
+ * Find the profile of an event type, adding it if it is new. There are only a
+ * few event types, so a linear search is fine. If there are more than the
+ * table has room for, the last entry counts all of the rest.
+ */
+
+static Event_Type_Profile *
+event_profile_type(Event_Profile_Ptr profile, Event * event)
+{
+  int i;
+
+  for (i=0; i<profile->number_of_types; i++) {
+    if (profile->types[i].function == event->function)
+      return profile->types + i;
+  }
+
+  if (i == EVENT_PROFILE_MAX_TYPES) return profile->types + i - 1;
+
+  if (i == EVENT_PROFILE_MAX_TYPES - 1) {
+    printf("Warning: More than %d event types to profile. The rest are "
+	   "counted as one.\n", EVENT_PROFILE_MAX_TYPES - 1);
+    profile->types[i].function = NULL;
+    profile->types[i].description = "(Other Event Types)";
+  } else {
+    profile->types[i].function = event->function;
+    profile->types[i].description = event->description;
+  }
+  profile->number_of_types++;
+  return profile->types + i;
+}
+
+/*
+ * An event was scheduled. scan_depth is the number of events passed over to
+ * find its place on the list (0 for the front), EVENT_PROFILE_BACK for the
+ * back, or EVENT_PROFILE_SOURCE for an event source, which isn't put on the
+ * list at all.
+ */
+
+void
+event_profile_schedule(Event_Profile_Ptr profile, Event * event,
+		       int scan_depth)
+{
+  event_profile_type(profile, event)->scheduled++;
+
+  if (scan_depth == EVENT_PROFILE_SOURCE) return;
+  if (scan_depth == EVENT_PROFILE_BACK) {
+    profile->back_insertions++;
+    return;
+  }
+  if (scan_depth == 0) profile->front_insertions++;
+  else profile->middle_insertions++;
+
+  profile->insertion_scan_total += scan_depth;
+  if (scan_depth > profile->insertion_scan_max)
+    profile->insertion_scan_max = scan_depth;
+  profile->insertion_scan_histogram[event_profile_bucket(scan_depth)]++;
+}
+
+/*
+ * An event was executed, when list_size events were pending, and its event
+ * function took the given number of cycles.
+ */
+
+void
+event_profile_execute(Event_Profile_Ptr profile, Event * event,
+		      int list_size, uint64_t cycles)
+{
+  Event_Type_Profile * type;
+
+  type = event_profile_type(profile, event);
+  type->executed++;
+  type->cycles += cycles;
+  type->cycle_histogram[event_profile_bucket(cycles)]++;
+
+  profile->list_size_total += list_size;
+  if (list_size > profile->list_size_max) profile->list_size_max = list_size;
+  profile->list_size_histogram[event_profile_bucket(list_size)]++;
+}
+
+/*
+ * An event was descheduled after scanning past scan_depth events.
+ */
+
+void
+event_profile_deschedule(Event_Profile_Ptr profile, Event * event,
+			 int scan_depth)
+{
+  event_profile_type(profile, event)->descheduled++;
+  profile->deschedule_scan_total += scan_depth;
+}
+
+/*
+ * The upper end of the histogram bucket holding quantile q.
+ */
+
+static uint64_t
+event_profile_quantile(uint64_t * histogram, uint64_t count, double q)
+{
+  uint64_t seen = 0;
+  int bucket;
+
+  for (bucket=0; bucket<EVENT_PROFILE_BUCKETS; bucket++) {
+    seen += histogram[bucket];
+    if (seen > 0 && seen >= q * count) break;
+  }
+  return bucket == 0 ? 0 : ((uint64_t) 1 << bucket) - 1;
+}
+
+static double
+event_profile_ratio(uint64_t numerator, uint64_t denominator)
+{
+  return denominator > 0 ? (double) numerator/denominator : 0.0;
+}
+
+/*
+ * Print the summary table.
+ */
+
+void
+event_profile_print(Event_Profile_Ptr profile, FILE * fp)
+{
+  Event_Type_Profile * type;
+  uint64_t cycles = 0, insertions, deschedules = 0, size_count = 0;
+  int i;
+
+  for (i=0; i<profile->number_of_types; i++) {
+    cycles += profile->types[i].cycles;
+    deschedules += profile->types[i].descheduled;
+  }
+
+  fprintf(fp, "\nEvent profile (cycles per event, p50/p99 are bucket upper bounds):\n");
+  fprintf(fp, "%-24s %12s %12s %10s %10s %8s %8s %7s\n", "Event type",
+	  "Scheduled", "Executed", "Desched.", "Mean", "p50", "p99", "Share");
+
+  for (i=0; i<profile->number_of_types; i++) {
+    type = profile->types + i;
+    fprintf(fp, "%-24.24s %12llu %12llu %10llu %10.0f %8llu %8llu %6.1f%%\n",
+	    type->description, (unsigned long long) type->scheduled,
+	    (unsigned long long) type->executed,
+	    (unsigned long long) type->descheduled,
+	    event_profile_ratio(type->cycles, type->executed),
+	    (unsigned long long) event_profile_quantile(type->cycle_histogram,
+							type->executed, 0.5),
+	    (unsigned long long) event_profile_quantile(type->cycle_histogram,
+							type->executed, 0.99),
+	    100 * event_profile_ratio(type->cycles, cycles));
+  }
+
+  for (i=0; i<EVENT_PROFILE_BUCKETS; i++)
+    size_count += profile->list_size_histogram[i];
+
+  fprintf(fp, "Event list size: mean %.2f, p99 %llu, max %d\n",
+	  event_profile_ratio(profile->list_size_total, size_count),
+	  (unsigned long long)
+	  event_profile_quantile(profile->list_size_histogram, size_count, 0.99),
+	  profile->list_size_max);
+
+  insertions = profile->front_insertions + profile->back_insertions +
+    profile->middle_insertions;
+  fprintf(fp, "Insertions: %llu (front %.1f%%, back %.1f%%, scanned %.1f%%), "
+	  "mean scan %.2f, p99 %llu, max %d\n", (unsigned long long) insertions,
+	  100 * event_profile_ratio(profile->front_insertions, insertions),
+	  100 * event_profile_ratio(profile->back_insertions, insertions),
+	  100 * event_profile_ratio(profile->middle_insertions, insertions),
+	  event_profile_ratio(profile->insertion_scan_total,
+			      profile->front_insertions +
+			      profile->middle_insertions),
+	  (unsigned long long)
+	  event_profile_quantile(profile->insertion_scan_histogram,
+				 profile->front_insertions +
+				 profile->middle_insertions, 0.99),
+	  profile->insertion_scan_max);
+
+  fprintf(fp, "Deschedules: %llu, mean scan %.2f\n",
+	  (unsigned long long) deschedules,
+	  event_profile_ratio(profile->deschedule_scan_total, deschedules));
+}
+
+void
+event_profile_free(Event_Profile_Ptr profile)
+{
+  xfree(profile);
+}
@@ -0,0 +1,131 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _EVENT_PROFILE_H_
+#define _EVENT_PROFILE_H_
+
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/******************************************************************************/
+
+struct _event_;
+
+/*
+ * Event list profiling. When a simulation_run has a profile, every event
+ * executed is counted and timed (in time stamp counter cycles) by event type,
+ * and the event list is measured: its size when each event is executed, and
+ * how far each insertion or removal had to scan along the list. The cycle,
+ * size and scan distributions are kept in power-of-two histograms. A summary
+ * table is printed at the end of the run.
+ */
+
+#define EVENT_PROFILE_MAX_TYPES 16
+#define EVENT_PROFILE_BUCKETS 48
+
+/* Scan depths of events that are put on the list without scanning. */
+#define EVENT_PROFILE_BACK -1
+#define EVENT_PROFILE_SOURCE -2
+
+typedef struct _event_type_profile_
+{
+  void (* function)(struct _simulation_run_ *, void *);
+  const char * description;
+  uint64_t scheduled;
+  uint64_t executed;
+  uint64_t descheduled;
+  uint64_t cycles;
+  uint64_t cycle_histogram[EVENT_PROFILE_BUCKETS];
+} Event_Type_Profile;
+
+typedef struct _event_profile_
+{
+  Event_Type_Profile types[EVENT_PROFILE_MAX_TYPES];
+  int number_of_types;
+  uint64_t list_size_total;
+  int list_size_max;
+  uint64_t list_size_histogram[EVENT_PROFILE_BUCKETS];
+  uint64_t front_insertions;
+  uint64_t back_insertions;
+  uint64_t middle_insertions;
+  uint64_t insertion_scan_total;
+  int insertion_scan_max;
+  uint64_t insertion_scan_histogram[EVENT_PROFILE_BUCKETS];
+  uint64_t deschedule_scan_total;
+} Event_Profile, * Event_Profile_Ptr;
+
+/*
+ * Read the cycle counter. Where there is none, nanoseconds are used instead.
+ */
+
+static inline uint64_t
+event_profile_cycles(void)
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+  return (uint64_t) __rdtsc();
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+#endif
+}
+
+/******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Event_Profile_Ptr
+event_profile_new(void);
+
+void
+event_profile_schedule(Event_Profile_Ptr, struct _event_ *, int);
+
+void
+event_profile_execute(Event_Profile_Ptr, struct _event_ *, int, uint64_t);
+
+void
+event_profile_deschedule(Event_Profile_Ptr, struct _event_ *, int);
+
+void
+event_profile_print(Event_Profile_Ptr, FILE *);
+
+void
+event_profile_free(Event_Profile_Ptr);
+
+/******************************************************************************/
+
+#endif /* event_profile.h */
@@ -0,0 +1,182 @@
+/*
+ *
+ * Simlib Simulation_Run Library
+ *
+ * Copyright (C) 2014 Terence D. Todd, Hamilton, Ontario, CANADA,
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simlib.h"
+#include "event_trace.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/******************************************************************************/
+
+/*
+ * Create a trace file holding a ring of (at least) the given number of
+ * records. Returns NULL (after printing a warning) if the file can't be
+ * created.
+ */
+
+Event_Trace_Ptr
+event_trace_open(const char * file_name, uint64_t capacity,
+		 Trace_Annotate_Function annotate)
+{
+  Event_Trace_Ptr trace;
+  size_t size;
+  void * mapping;
+  uint64_t ring_size;
+#ifdef _WIN32
+  FILE * fp;
+#endif
+
+  /* Round the ring up to a power of two so that wrapping is a mask. */
+  for (ring_size = 1; ring_size < capacity; ring_size <<= 1);
+  capacity = ring_size;
+
+  size = sizeof(Trace_Header) + capacity * sizeof(Trace_Record);
+
+#ifndef _WIN32
+  {
+    int fd;
+
+    if ((fd = open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 ||
+	ftruncate(fd, (off_t) size) != 0 ||
+	(mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0)) == MAP_FAILED) {
+      printf("Warning: Cannot create trace file %s\n", file_name);
+      if (fd >= 0) close(fd);
+      return NULL;
+    }
+    close(fd);
+  }
+#else
+  /* No mmap here. Keep the ring in memory and write it out on close. */
+  if ((fp = fopen(file_name, "wb")) == NULL) {
+    printf("Warning: Cannot create trace file %s\n", file_name);
+    return NULL;
+  }
+  mapping = xcalloc(1, (unsigned) size);
+#endif
+
+  trace = (Event_Trace_Ptr) xcalloc(1, sizeof(Event_Trace));
+  trace->header = (Trace_Header_Ptr) mapping;
+  trace->records = (Trace_Record_Ptr) (trace->header + 1);
+  trace->annotate = annotate;
+  trace->mask = capacity - 1;
+  trace->mapped_size = size;
+#ifdef _WIN32
+  trace->file = (void *) fp;
+#endif
+
+  memcpy(trace->header->magic, EVENT_TRACE_MAGIC, sizeof(trace->header->magic));
+  trace->header->version = EVENT_TRACE_VERSION;
+  trace->header->record_size = sizeof(Trace_Record);
+  trace->header->capacity = capacity;
+  trace->header->records_written = 0;
+  trace->header->number_of_types = 0;
+  return trace;
+}
+
+/*
+ * Find the type number of an event, registering it if it is new. There are
+ * only a few event types, so a linear search is fine. If there are more than
+ * the header has room for, the last type stands for all of the rest.
+ */
+
+static int
+event_trace_type(Event_Trace_Ptr trace, Event * event)
+{
+  uint32_t i;
+
+  for (i=0; i<trace->header->number_of_types; i++) {
+    if (trace->functions[i] == event->function) return (int) i;
+  }
+
+  if (i == EVENT_TRACE_MAX_TYPES) return EVENT_TRACE_MAX_TYPES - 1;
+
+  if (i == EVENT_TRACE_MAX_TYPES - 1) {
+    printf("Warning: More than %d event types to trace. The rest are "
+	   "traced as one.\n", EVENT_TRACE_MAX_TYPES - 1);
+    trace->functions[i] = NULL;
+    strcpy(trace->header->descriptions[i], "(Other Event Types)");
+  } else {
+    trace->functions[i] = event->function;
+    strncpy(trace->header->descriptions[i], event->description,
+	    EVENT_TRACE_DESCRIPTION_LENGTH - 1);
+  }
+  trace->header->number_of_types++;
+  return (int) i;
+}
+
+/*
+ * Append a record to the ring.
+ */
+
+void
+event_trace_record(Event_Trace_Ptr trace, Simulation_Run_Ptr simulation_run,
+		   Trace_Operation operation, double now, Event * event,
+		   double event_time, long int event_id)
+{
+  Trace_Record_Ptr record;
+
+  record = trace->records + (trace->header->records_written & trace->mask);
+
+  record->time = now;
+  record->event_time = event_time;
+  record->event_id = event_id;
+  record->packet_id = -1;
+  record->station_id = -1;
+  record->operation = (uint8_t) operation;
+  record->event_type = (uint8_t) event_trace_type(trace, event);
+  record->channel_state = -1;
+  record->reserved = 0;
+
+  if (trace->annotate != NULL)
+    (*trace->annotate)(simulation_run, event->attachment, record);
+
+  trace->header->records_written++;
+}
+
+/*
+ * Close the trace. The file stays behind for decoding.
+ */
+
+void
+event_trace_close(Event_Trace_Ptr trace)
+{
+#ifndef _WIN32
+  munmap((void *) trace->header, trace->mapped_size);
+#else
+  fwrite(trace->header, trace->mapped_size, 1, (FILE *) trace->file);
+  fclose((FILE *) trace->file);
+  xfree(trace->header);
+#endif
+  xfree(trace);
+}
+
@@ -0,0 +1,123 @@
+/*
+ *
+ * Simlib Simulation_Run Library
+ *
+ * Copyright (C) 2014 Terence D. Todd, Hamilton, Ontario, CANADA,
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 3 of the License, or (at your option) any later
+ * version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _EVENT_TRACE_H_
+#define _EVENT_TRACE_H_
+
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************/
+
+struct _simulation_run_;
+struct _event_;
+
+/*
+ * Binary event trace. Fixed-size records are written into a ring of
+ * records in a memory-mapped file, so recording an event is a handful of
+ * stores and the file is readable even if the program dies. When the ring is
+ * full the oldest records are overwritten. The header keeps the total number
+ * of records written and the descriptions of the event types seen, so the
+ * file can be decoded offline (see tools/trace_decode.c).
+ *
+ * The station, packet and channel state fields are filled in by an optional
+ * annotate function supplied by the simulation, since simlib itself knows
+ * nothing about them. Fields that don't apply are -1.
+ */
+
+#define EVENT_TRACE_MAGIC "SIMTRACE"
+#define EVENT_TRACE_VERSION 2
+#define EVENT_TRACE_MAX_TYPES 64
+#define EVENT_TRACE_DESCRIPTION_LENGTH 32
+#define EVENT_TRACE_DEFAULT_RECORDS (1 << 20)
+
+typedef enum {TRACE_SCHEDULE, TRACE_EXECUTE, TRACE_DESCHEDULE} Trace_Operation;
+
+typedef struct _trace_record_
+{
+  double time;
+  double event_time;
+  int64_t event_id;
+  int64_t packet_id;
+  int32_t station_id;
+  uint8_t operation;
+  uint8_t event_type;
+  int8_t channel_state;
+  uint8_t reserved;
+} Trace_Record, * Trace_Record_Ptr;
+
+typedef struct _trace_header_
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t capacity;
+  uint64_t records_written;
+  uint32_t number_of_types;
+  uint32_t reserved;
+  char descriptions[EVENT_TRACE_MAX_TYPES][EVENT_TRACE_DESCRIPTION_LENGTH];
+} Trace_Header, * Trace_Header_Ptr;
+
+/*
+ * Called for each record with the event's attachment, to fill in the
+ * simulation-specific fields.
+ */
+
+typedef void (* Trace_Annotate_Function)(struct _simulation_run_ *, void *,
+					 Trace_Record_Ptr);
+
+typedef struct _event_trace_
+{
+  Trace_Header_Ptr header;
+  Trace_Record_Ptr records;
+  void (* functions[EVENT_TRACE_MAX_TYPES])(struct _simulation_run_ *, void *);
+  Trace_Annotate_Function annotate;
+  uint64_t mask;
+  size_t mapped_size;
+  void * file;
+} Event_Trace, * Event_Trace_Ptr;
+
+/******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Event_Trace_Ptr
+event_trace_open(const char *, uint64_t, Trace_Annotate_Function);
+
+void
+event_trace_record(Event_Trace_Ptr, struct _simulation_run_ *, Trace_Operation,
+		   double, struct _event_ *, double, long int);
+
+void
+event_trace_close(Event_Trace_Ptr);
+
+/******************************************************************************/
+
+#endif /* event_trace.h */
+
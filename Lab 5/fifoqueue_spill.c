@@ -0,0 +1,423 @@
+
+/*
+ * 
+ * Simlib Simulation Library
+ * 
+ * Copyright (C) 2014 Terence D. Todd
+ * Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "simlib.h"
+#include "fifoqueue_spill.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#else
+#define MADV_DONTNEED 0
+#define MADV_WILLNEED 0
+#endif
+
+/******************************************************************************/
+
+#define spill_record(spill, i) \
+  ((spill)->mapping + ((spill)->first + (i)) % (spill)->capacity * \
+   (spill)->record_size)
+
+/*
+ * Create an empty, already unlinked, temporary file. Returns -1 (after
+ * printing a warning) if it can't be created.
+ */
+
+static int
+spill_file_new(void)
+{
+#ifndef _WIN32
+  const char * directory;
+  char name[FILENAME_MAX];
+  int fd;
+
+  if ((directory = getenv("TMPDIR")) == NULL || *directory == '\0')
+    directory = "/tmp";
+  snprintf(name, sizeof(name), "%s/aloha-spill-XXXXXX", directory);
+
+  if ((fd = mkstemp(name)) < 0) {
+    printf("Warning: Cannot create queue spill file in %s\n", directory);
+    return -1;
+  }
+  unlink(name);
+  return fd;
+#else
+  printf("Warning: Queue spill files are not available on this platform\n");
+  return -1;
+#endif
+}
+
+/*
+ * Map the spill file with room for capacity records.
+ */
+
+static char *
+spill_map(Fifoqueue_Spill_Ptr spill, long int capacity)
+{
+  void * mapping = NULL;
+#ifndef _WIN32
+  size_t size = (size_t) capacity * spill->record_size;
+
+  if (ftruncate(spill->fd, (off_t) size) != 0 ||
+      (mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		      spill->fd, 0)) == MAP_FAILED) {
+    printf("Error: Cannot grow the queue spill file to %ld records\n",
+	   capacity);
+    exit(1);
+  }
+#endif
+  return (char *) mapping;
+}
+
+static void
+spill_unmap(Fifoqueue_Spill_Ptr spill)
+{
+#ifndef _WIN32
+  if (spill->mapping != NULL)
+    munmap((void *) spill->mapping,
+	   (size_t) spill->capacity * spill->record_size);
+#endif
+  spill->mapping = NULL;
+}
+
+/*
+ * Give the kernel a hint about records first to first+count (not wrapped).
+ * Only whole pages inside the range are covered.
+ */
+
+static void
+spill_advise(Fifoqueue_Spill_Ptr spill, long int first, long int count,
+	     int advice)
+{
+#ifndef _WIN32
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  size_t start = (size_t) first * spill->record_size;
+  size_t end = (size_t) (first + count) * spill->record_size;
+
+  start = (start + page - 1)/page*page;
+  end = end/page*page;
+  if (end > start)
+    madvise((void *) (spill->mapping + start), end - start, advice);
+#else
+  (void) spill; (void) first; (void) count; (void) advice;
+#endif
+}
+
+/*
+ * Make room for at least needed records. The ring is unwrapped into the new
+ * space, so the records stay in order from first.
+ */
+
+static void
+spill_grow(Fifoqueue_Spill_Ptr spill, long int needed)
+{
+  long int capacity, wrapped;
+
+  capacity = spill->capacity > 0 ? spill->capacity : 4L*spill->segment_length;
+  while (capacity < needed) capacity *= 2;
+
+  spill_unmap(spill);
+  spill->mapping = spill_map(spill, capacity);
+
+  wrapped = spill->first + spill->count - spill->capacity;
+  if (wrapped > 0)
+    memcpy(spill->mapping + (size_t) spill->capacity * spill->record_size,
+	   spill->mapping, (size_t) wrapped * spill->record_size);
+  spill->capacity = capacity;
+}
+
+/******************************************************************************/
+
+/*
+ * Make a spill for a queue of record_size byte blocks, which are given back
+ * with the given tag. Returns NULL (after printing a warning) if the file
+ * can't be created; the queue then simply stays in memory.
+ */
+
+Fifoqueue_Spill_Ptr
+fifoqueue_spill_open(unsigned record_size, int segment_length, Memory_Tag tag)
+{
+  Fifoqueue_Spill_Ptr spill;
+  int fd;
+
+  if ((fd = spill_file_new()) < 0) return NULL;
+
+  spill = (Fifoqueue_Spill_Ptr) xcalloc_tagged(1, sizeof(Fifoqueue_Spill),
+					       MEMORY_QUEUES);
+  spill->record_size = record_size;
+  spill->segment_length = segment_length > 0 ? segment_length : 1;
+  spill->tag = tag;
+  spill->fd = fd;
+  return spill;
+}
+
+/*
+ * Unmap the pages of n records from the i-th on, which have just been
+ * written or read back. Written pages stay in the file, so this only keeps
+ * them from counting against the process.
+ */
+
+static void
+spill_release(Fifoqueue_Spill_Ptr spill, long int i, long int n)
+{
+  long int start = (spill->first + i) % spill->capacity;
+  long int before_end = spill->capacity - start;
+
+  if (n <= before_end) spill_advise(spill, start, n, MADV_DONTNEED);
+  else {
+    spill_advise(spill, start, before_end, MADV_DONTNEED);
+    spill_advise(spill, 0, n - before_end, MADV_DONTNEED);
+  }
+}
+
+/*
+ * Write the tail out after the records already in the file.
+ */
+
+static void
+spill_tail(Fifoqueue_Ptr queue)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+  Queue_Container_Ptr container, next;
+  long int start = spill->count;
+
+  if (spill->count + spill->tail_size > spill->capacity)
+    spill_grow(spill, spill->count + spill->tail_size);
+
+  for (container = spill->tail_front; container != NULL; container = next) {
+    next = container->next_ptr;
+    memcpy(spill_record(spill, spill->count), container->content_ptr,
+	   spill->record_size);
+    spill->count++;
+    xfree(container->content_ptr);
+    xfree((void *) container);
+  }
+  spill_release(spill, start, spill->count - start);
+  spill->tail_front = NULL;
+  spill->tail_size = 0;
+  queue->back_ptr = spill->head_back;
+}
+
+/*
+ * Refill the empty head with the next segment from the file, or else take
+ * over the tail.
+ */
+
+static void
+spill_refill(Fifoqueue_Ptr queue)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+  Queue_Container_Ptr container;
+  long int i, n;
+
+  if (spill->count == 0) {
+    queue->front_ptr = spill->tail_front;
+    spill->head_back = spill->tail_front != NULL ? queue->back_ptr : NULL;
+    spill->head_size = spill->tail_size;
+    spill->tail_front = NULL;
+    spill->tail_size = 0;
+    return;
+  }
+
+  n = spill->count < spill->segment_length ? spill->count :
+    spill->segment_length;
+
+  for (i=0; i<n; i++) {
+    container = (Queue_Container_Ptr)
+      xmalloc_tagged(sizeof(Queue_Container), MEMORY_QUEUES);
+    container->content_ptr = xmalloc_tagged(spill->record_size, spill->tag);
+    memcpy(container->content_ptr, spill_record(spill, i), spill->record_size);
+    container->next_ptr = NULL;
+
+    if (spill->head_size == 0) queue->front_ptr = container;
+    else spill->head_back->next_ptr = container;
+    spill->head_back = container;
+    spill->head_size++;
+  }
+
+  spill_release(spill, 0, n);
+  spill->first = (spill->first + n) % spill->capacity;
+  spill->count -= n;
+
+  /* Start reading the next segment while this one is used. */
+  if (spill->count == 0) spill->first = 0;
+  else spill_advise(spill, spill->first,
+		    spill->capacity - spill->first < spill->segment_length ?
+		    spill->capacity - spill->first : spill->segment_length,
+		    MADV_WILLNEED);
+
+  if (spill->tail_front == NULL) queue->back_ptr = spill->head_back;
+}
+
+/*
+ * Add a container at the back. It goes on the head if nothing is queued
+ * behind the head and there is room, otherwise on the tail.
+ */
+
+void
+fifoqueue_spill_put(Fifoqueue_Ptr queue, Queue_Container_Ptr container)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+
+  if (spill->count == 0 && spill->tail_size == 0 &&
+      spill->head_size < spill->segment_length) {
+    if (spill->head_size == 0) queue->front_ptr = container;
+    else spill->head_back->next_ptr = container;
+    spill->head_back = container;
+    spill->head_size++;
+  } else {
+    if (spill->tail_size == 0) spill->tail_front = container;
+    else queue->back_ptr->next_ptr = container;
+    spill->tail_size++;
+  }
+  queue->back_ptr = container;
+
+  if (spill->tail_size >= spill->segment_length) spill_tail(queue);
+}
+
+/*
+ * Take the container at the front, refilling the head if it runs out.
+ */
+
+Queue_Container_Ptr
+fifoqueue_spill_get(Fifoqueue_Ptr queue)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+  Queue_Container_Ptr container;
+
+  container = queue->front_ptr;
+  queue->front_ptr = container->next_ptr;
+  if (--spill->head_size == 0) {
+    spill->head_back = NULL;
+    spill_refill(queue);
+  }
+  if (queue->front_ptr == NULL) queue->back_ptr = NULL;
+  return container;
+}
+
+/*
+ * Call visit for each thing in the queue, front to back, including the
+ * records in the file (in place, so they must not be kept or changed). Stops
+ * at, and returns, the first non-zero value visit returns.
+ */
+
+int
+fifoqueue_spill_visit(Fifoqueue_Ptr queue, int (* visit)(void *, void *),
+		      void * argument)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+  Queue_Container_Ptr container;
+  long int i;
+  int result;
+
+  for (container = queue->front_ptr; container != NULL;
+       container = container->next_ptr)
+    if ((result = visit(container->content_ptr, argument)) != 0) return result;
+
+  for (i=0; i<spill->count; i++)
+    if ((result = visit((void *) spill_record(spill, i), argument)) != 0)
+      return result;
+
+  for (container = spill->tail_front; container != NULL;
+       container = container->next_ptr)
+    if ((result = visit(container->content_ptr, argument)) != 0) return result;
+
+  return 0;
+}
+
+/*
+ * Move the records to a new file of their own. A process forked after the
+ * spill was opened must do this before putting anything in the queue, since
+ * the file would otherwise be shared.
+ */
+
+void
+fifoqueue_spill_reopen(Fifoqueue_Ptr queue)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+  Fifoqueue_Spill old;
+  long int i;
+  int fd;
+
+  if ((fd = spill_file_new()) < 0) {
+    printf("Error: Cannot reopen the queue spill file\n");
+    exit(1);
+  }
+
+  old = *spill;
+  spill->fd = fd;
+  spill->mapping = NULL;
+  spill->first = 0;
+  spill->count = 0;
+  spill->capacity = 0;
+  if (old.capacity > 0) {
+    spill_grow(spill, old.capacity);
+    for (i=0; i<old.count; i++)
+      memcpy(spill_record(spill, i), spill_record(&old, i), spill->record_size);
+  }
+  spill->count = old.count;
+
+  spill_unmap(&old);
+#ifndef _WIN32
+  close(old.fd);
+#endif
+}
+
+/*
+ * Free the spill along with the containers still in memory. As with
+ * fifoqueue_free, the contents are not freed.
+ */
+
+void
+fifoqueue_spill_close(Fifoqueue_Ptr queue)
+{
+  Fifoqueue_Spill_Ptr spill = queue->spill;
+  Queue_Container_Ptr container, next;
+
+  for (container = queue->front_ptr; container != NULL; container = next) {
+    next = container->next_ptr;
+    xfree((void *) container);
+  }
+  for (container = spill->tail_front; container != NULL; container = next) {
+    next = container->next_ptr;
+    xfree((void *) container);
+  }
+  queue->front_ptr = queue->back_ptr = NULL;
+  queue->size = 0;
+
+  spill_unmap(spill);
+#ifndef _WIN32
+  close(spill->fd);
+#endif
+  xfree((void *) spill);
+  queue->spill = NULL;
+}
+
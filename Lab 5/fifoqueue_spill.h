@@ -0,0 +1,98 @@
+
+/*
+ * 
+ * Simlib Simulation Library
+ * 
+ * Copyright (C) 2014 Terence D. Todd
+ * Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _FIFOQUEUE_SPILL_H_
+#define _FIFOQUEUE_SPILL_H_
+
+/******************************************************************************/
+
+#include "simlib.h"
+
+/******************************************************************************/
+
+/*
+ * Out-of-core FIFO queues. A queue with a spill keeps only its ends in
+ * memory: a head list of at most segment_length containers, from which
+ * fifoqueue_get takes, and a tail list, to which fifoqueue_put adds. Each
+ * time the tail reaches segment_length while something is queued ahead of
+ * it, its contents are copied as fixed-size records to a memory-mapped
+ * temporary file (in $TMPDIR, or /tmp) and their memory is freed. When the
+ * head runs out, it is refilled with the next segment of records, each
+ * copied back into a block from xmalloc_tagged, and the kernel is asked to
+ * read the following segment ahead.
+ *
+ * The records are kept in a ring that doubles in size when full, so the
+ * file is only as big as the longest backlog. The contents must be blocks
+ * of record_size bytes that nothing but the queue refers to while they
+ * are behind the head, since a spilled block comes back at a different
+ * address.
+ */
+
+typedef struct _fifoqueue_spill_
+{
+  unsigned record_size;
+  int segment_length;
+  Memory_Tag tag;
+  Queue_Container_Ptr head_back;
+  int head_size;
+  Queue_Container_Ptr tail_front;
+  int tail_size;
+  long int first;
+  long int count;
+  long int capacity;
+  int fd;
+  char * mapping;
+} Fifoqueue_Spill, * Fifoqueue_Spill_Ptr;
+
+/******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Fifoqueue_Spill_Ptr
+fifoqueue_spill_open(unsigned, int, Memory_Tag);
+
+void
+fifoqueue_spill_put(Fifoqueue_Ptr, Queue_Container_Ptr);
+
+Queue_Container_Ptr
+fifoqueue_spill_get(Fifoqueue_Ptr);
+
+int
+fifoqueue_spill_visit(Fifoqueue_Ptr, int (*)(void *, void *), void *);
+
+void
+fifoqueue_spill_reopen(Fifoqueue_Ptr);
+
+void
+fifoqueue_spill_close(Fifoqueue_Ptr);
+
+/******************************************************************************/
+
+#endif /* fifoqueue_spill.h */
+
@@ -25,12 +25,19 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 #include "output.h"
 #include "trace.h"
 #include "simparameters.h"
 #include "cleanup.h"
 #include "packet_arrival.h"
 #include "packet_transmission.h"
+#include "branch.h"
+#include "checkpoint.h"
+#include "perf_counters.h"
+#include "random_streams.h"
+#include "regenerative.h"
+#include "restart.h"
 #include "main.h"
 
 /*******************************************************************************/
@@ -44,14 +51,45 @@ main(void)
 
   Simulation_Run_Ptr simulation_run;
   Simulation_Run_Data data;
-  int i, j=0;
+  Delay_Stats all_seeds_delay_stats;
+  Perf_Counters_Ptr perf_counters;
+  Warm_Start_Ptr warm_start, warm_start_recorder;
+#if RESTART_SPLITTING
+  Restart_Ptr restart;
+#endif
+#if ANTITHETIC_PAIRS
+  double pair_delays[sizeof(RANDOM_SEEDS)/sizeof(unsigned)];
+  int pairs = 0;
+#endif
+  int antithetic;
+#if BENCHMARK_SUMMARY
+  clock_t run_start;
+#endif
+  int j=0;
+
+  delay_stats_initialize(&all_seeds_delay_stats);
+
+#if REGENERATIVE_CYCLES > 0
+  /* Simulate independent regenerative cycles in parallel instead. */
+  regenerative_run_parallel(RANDOM_SEEDS[0]);
+  getchar();
+  return 0;
+#endif
+
+  warm_start = output_open_warm_start();
+  warm_start_recorder = output_open_warm_start_recorder();
 
-  /* Do a new simulation_run for each random number generator seed. */
-  while ((random_seed = RANDOM_SEEDS[j++]) != 0) {
+  /* Do a new simulation_run for each random number generator seed, or two,
+     the second antithetic, with ANTITHETIC_PAIRS. */
+  while ((random_seed = RANDOM_SEEDS[j/(ANTITHETIC_PAIRS+1)]) != 0) {
+    antithetic = j++ % (ANTITHETIC_PAIRS+1);
 
     /* Set the random generator seed. */
     random_generator_initialize(random_seed);
 
+    /* Each run reports its own memory use. */
+    memory_usage_reset();
+
     /* Create a new simulation_run. This gives a clock and
        eventlist. Clock time is set to zero. */
     simulation_run = (Simulation_Run_Ptr) simulation_run_new();
@@ -59,70 +97,226 @@ main(void)
     /* Add our data definitions to the simulation_run. */
     simulation_run_set_data(simulation_run, (void *) & data);
 
-    /* Create and initalize the stations. */
-    data.stations = (Station_Ptr) xcalloc((unsigned int) NUMBER_OF_STATIONS,
-					  sizeof(Station));
-
-    /* Initialize various simulation_run variables. */
-    data.blip_counter = 0;
-    data.arrival_count = 0;
-    data.packets_transmitted = 0;
-    data.packets_processed = 0;
-    data.number_of_collisions = 0;
-    data.accumulated_delay = 0.0;
-    data.random_seed = random_seed;
-    
-    /* Initialize the stations. */
-    for(i=0; i<NUMBER_OF_STATIONS; i++) {
-      (data.stations+i)->id = i;
-      (data.stations+i)->buffer = fifoqueue_new();
-      (data.stations+i)->arrival_count = 0;
-      (data.stations + i)->packets_transmitted = 0;
-      (data.stations + i)->packets_processed = 0;
-      (data.stations + i)->number_of_collisions = 0;
-      (data.stations+i)->accumulated_delay = 0.0;
-      (data.stations+i)->mean_delay = 0;
-
+    /* Record a binary event trace and export packets if asked for. */
+    output_open_trace(simulation_run, random_seed);
+    data.packet_export = output_open_packet_export(random_seed);
+    data.metrics = output_open_metrics(random_seed);
+    output_open_profile(simulation_run);
+    perf_counters = output_open_perf_counters();
+
+    /* Create the stations, channel and cloud server, and reset the
+       statistics. */
+    run_initialize(simulation_run, random_seed, antithetic);
+
+#if CHECKPOINT
+    checkpoint_initialize(simulation_run);
+#endif
+
+#if CHECKPOINT_RESTORE
+    /* Resume from the checkpoint, or start from scratch if there isn't one. */
+    if (!checkpoint_restore_file(simulation_run))
+#endif
+    /* Replay recorded arrivals, or schedule the initial packet arrival. */
+    if (!schedule_trace_arrivals(simulation_run)) {
+      /* Start near steady state if there are snapshots to start from. */
+      if (warm_start != NULL) warm_start_sample(warm_start, simulation_run);
+      event_source_schedule_next(simulation_run, data.arrival_source);
     }
 
-    /* Create and initialize the channel and servers. */
-    data.channel = channel_new();
-    data.cloud_server = server_new();
+    data.progress = progress_start(simulation_run, 0);
+    if (perf_counters != NULL) perf_counters_start(perf_counters, simulation_run);
+#if BENCHMARK_SUMMARY
+    run_start = clock();
+#endif
 
-    /* Create and initalize FCFS buffer for data */
-    data.cloud_server_queue = fifoqueue_new();
+#if WARMUP_LENGTH > 0
+    /* Simulate the warm-up once, then branch from the warmed-up state. */
+    while(data.packets_processed < WARMUP_LENGTH &&
+	  simulation_run_events_pending(simulation_run)) {
+      simulation_run_execute_event(simulation_run);
+    }
 
-    /* Schedule initial packet arrival. */
-    schedule_packet_arrival_event(simulation_run, 
-		    simulation_run_get_time(simulation_run) +
-		    exponential_generator((double) 1/PACKET_ARRIVAL_RATE));
+    /* The branches report their own progress. */
+    if (perf_counters != NULL) perf_counters_stop(perf_counters, simulation_run);
+    progress_stop(data.progress);
 
+    if (perf_counters != NULL) {
+      printf("\nWarm-up ");
+      perf_counters_print(perf_counters, data.packets_processed);
+    }
+    branch_from_warm_state(simulation_run);
+#else
+#if RESTART_SPLITTING
+    /* Split the run at the RESTART thresholds. */
+    restart = restart_new();
+    restart_run(restart, simulation_run);
+#else
     /* Execute events until we are finished. */
-    while(data.packets_processed < RUNLENGTH) {
+    while(run_in_progress(simulation_run)) {
       simulation_run_execute_event(simulation_run);
+#if CHECKPOINT
+      checkpoint_poll(simulation_run);
+#endif
+      if (warm_start_recorder != NULL)
+	warm_start_poll(warm_start_recorder, simulation_run);
     }
+#endif
+    if (perf_counters != NULL) perf_counters_stop(perf_counters, simulation_run);
+    progress_stop(data.progress);
 
     /* Print out some results. */
     output_results(simulation_run);
+#if RESTART_SPLITTING
+    output_restart(restart);
+    restart_free(restart);
+#endif
+    if (perf_counters != NULL)
+      perf_counters_print(perf_counters, data.packets_processed);
+#if BENCHMARK_SUMMARY
+    output_benchmark_summary(simulation_run,
+			     (double) (clock() - run_start)/CLOCKS_PER_SEC);
+#endif
+    delay_stats_merge(&all_seeds_delay_stats, &data.delay_stats);
+
+#if ANTITHETIC_PAIRS
+    /* A pair's estimate is the average of its two runs. */
+    if (!antithetic) pair_delays[pairs] = data.delay_stats.mean/2;
+    else pair_delays[pairs++] += data.delay_stats.mean/2;
+#endif
+#endif
+
+    if (perf_counters != NULL) perf_counters_close(perf_counters);
 
     /* Clean up memory. */
     cleanup(simulation_run);
   }
 
+#if WARMUP_LENGTH == 0
+  /* Branches report on their own, and aren't merged here. */
+  output_delay_distribution("All Seeds", &all_seeds_delay_stats);
+#endif
+  if (warm_start_recorder != NULL) warm_start_close(warm_start_recorder);
+  if (warm_start != NULL) warm_start_free(warm_start);
+#if ANTITHETIC_PAIRS && WARMUP_LENGTH == 0
+  output_antithetic_pairs(pair_delays, pairs);
+#endif
+
   /* Pause before finishing. */
   getchar();
 
   return 0;
 }
 
+/*
+ * A run goes on until RUNLENGTH packets have been processed, unless it is
+ * stopped early, runs out of events, or uses up its event budget.
+ */
 
+int
+run_in_progress(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
 
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
 
+  return data->packets_processed < RUNLENGTH && !data->stop_run &&
+    simulation_run_events_pending(simulation_run) &&
+    (EVENT_BUDGET == 0 || simulation_run->events_executed < EVENT_BUDGET);
+}
 
+/*
+ * Create the stations, channel and cloud server of a new simulation_run,
+ * zero its statistics and seed its random streams. The caller has set the
+ * run's data, and its packet export, metrics and arrival traces.
+ */
 
+void
+run_initialize(Simulation_Run_Ptr simulation_run, unsigned random_seed,
+	       int antithetic)
+{
+  Simulation_Run_Data_Ptr data;
+
+  /* The true means of the packet inputs, for the control variates: station
+     0 uploads in MEAN_UPLOAD_DURATION, the others take ten times longer, and
+     backoffs are MEAN_BACKOFF_DURATION on average, so that their excess over
+     it sums to zero on average however many there are. */
+  double control_means[CONTROLS] = {
+    1.0/PACKET_ARRIVAL_RATE,
+    MEAN_UPLOAD_DURATION * (1.0 + 10.0*(NUMBER_OF_STATIONS-1))/
+    NUMBER_OF_STATIONS,
+    MEAN_PACKET_DURATION,
+    0.0
+  };
+  int i;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  /* Create and initalize the stations. */
+  data->stations = (Station_Ptr)
+    xcalloc_tagged((unsigned int) NUMBER_OF_STATIONS, sizeof(Station),
+		   MEMORY_STATIONS);
+
+  /* Initialize various simulation_run variables. */
+  data->blip_counter = 0;
+  data->next_packet_id = 0;
+  data->arrival_count = 0;
+  data->packets_transmitted = 0;
+  data->packets_processed = 0;
+  data->number_of_collisions = 0;
+  data->packets_dropped = 0;
+  data->packets_in_system = 0;
+  data->tail_packets = 0;
+  data->accumulated_delay = 0.0;
+  delay_stats_initialize(&data->delay_stats);
+  data->stop_run = 0;
+  data->mean_backoff_duration = MEAN_BACKOFF_DURATION;
+  data->random_seed = random_seed;
+
+  /* Initialize the stations. */
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    (data->stations+i)->id = i;
+    (data->stations+i)->buffer = fifoqueue_new();
+    fifoqueue_track_occupancy((data->stations+i)->buffer, simulation_run);
+#if QUEUE_SPILL_SEGMENT > 0
+    fifoqueue_enable_spill((data->stations+i)->buffer, sizeof(Packet),
+			   QUEUE_SPILL_SEGMENT, MEMORY_PACKETS);
+#endif
+    (data->stations+i)->arrival_count = 0;
+    (data->stations + i)->packets_transmitted = 0;
+    (data->stations + i)->packets_processed = 0;
+    (data->stations + i)->number_of_collisions = 0;
+    (data->stations + i)->packets_dropped = 0;
+    (data->stations+i)->accumulated_delay = 0.0;
+    (data->stations+i)->mean_delay = 0;
+    delay_stats_initialize(&(data->stations+i)->delay_stats);
 
+  }
 
-
-
-
-
+  /* Create and initialize the channel and servers. */
+  data->channel = channel_new();
+  data->cloud_server = server_new();
+
+  /* Create and initalize FCFS buffer for data */
+  data->cloud_server_queue = fifoqueue_new();
+
+  /* Track time-average occupancy and utilization. */
+  channel_track_utilization(data->channel, simulation_run);
+  server_track_utilization(data->cloud_server, simulation_run);
+  fifoqueue_track_occupancy(data->cloud_server_queue, simulation_run);
+#if QUEUE_SPILL_SEGMENT > 0
+  fifoqueue_enable_spill(data->cloud_server_queue, sizeof(Packet),
+			 QUEUE_SPILL_SEGMENT, MEMORY_PACKETS);
+#endif
+
+  batch_means_initialize(&data->delay_batches, INITIAL_BATCH_SIZE,
+			 simulation_run_get_time(simulation_run));
+  warmup_detector_initialize(&data->warmup);
+  saturation_detector_initialize(&data->saturation, 0);
+  data->last_arrival_time = 0.0;
+  control_variates_initialize(&data->control_variates, INITIAL_BATCH_SIZE,
+			      control_means);
+  regenerative_initialize(&data->regeneration, 0);
+
+  data->arrival_source = packet_arrival_source_new(simulation_run);
+  random_streams_initialize(simulation_run, random_seed, antithetic);
+}
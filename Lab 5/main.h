@@ -33,6 +33,16 @@
 #include "simlib.h"
 #include "simparameters.h"
 #include "channel.h"
+#include "batch_means.h"
+#include "warmup.h"
+#include "saturation.h"
+#include "control_variates.h"
+#include "regenerative.h"
+#include "delay_stats.h"
+#include "packet_export.h"
+#include "arrival_trace.h"
+#include "progress.h"
+#include "metrics.h"
 
 /**********************************************************************/
 
@@ -49,8 +59,11 @@ typedef struct _station_
   long int packets_transmitted;
   long int packets_processed;
   long int number_of_collisions;
+  long int packets_dropped;
   double accumulated_delay;
   double mean_delay;
+  Delay_Stats delay_stats;
+  Rand_Stream backoff_stream;
 } Station, * Station_Ptr;
 
 /**********************************************************************/
@@ -59,9 +72,15 @@ typedef enum {WAITING, TRANSMITTING} Packet_Status;
 
 typedef struct _packet_ 
 {
+  long int id;
   double arrive_time;
   double service_time;
   double upload_time;
+  double first_transmit_time;
+  double success_time;
+  double cloud_start_time;
+  double interarrival_time;
+  double backoff_excess;
   int station_id;
   Packet_Status status;
   int collision_count;
@@ -73,14 +92,36 @@ typedef struct _simulation_run_data_
   Channel_Ptr channel;
   Fifoqueue_Ptr cloud_server_queue;
   Server_Ptr cloud_server;
+  Packet_Export_Ptr packet_export;
+  Metrics_Ptr metrics;
+  Event_Source_Ptr arrival_source;
+  Progress_Ptr progress;
+  Arrival_Trace_Ptr arrival_traces;
   long int blip_counter;
+  long int next_packet_id;
   long int arrival_count;
   long int packets_transmitted;
   long int packets_processed;
   long int number_of_collisions;
+  long int packets_dropped;
+  long int packets_in_system;
+  long int tail_packets;
   double accumulated_delay;
+  Delay_Stats delay_stats;
+  long int next_checkpoint;
+  Batch_Means delay_batches;
+  Warmup_Detector warmup;
+  Saturation_Detector saturation;
+  double last_arrival_time;
+  Control_Variates control_variates;
+  Regenerative regeneration;
+  int stop_run;
+  double mean_backoff_duration;
 
   unsigned random_seed;
+  int antithetic;
+  Rand_Stream arrival_stream;
+  Rand_Stream station_stream;
 } Simulation_Run_Data, * Simulation_Run_Data_Ptr;
 
 /**********************************************************************/
@@ -92,6 +133,12 @@ typedef struct _simulation_run_data_
 int
 main(void);
 
+int
+run_in_progress(Simulation_Run_Ptr);
+
+void
+run_initialize(Simulation_Run_Ptr, unsigned, int);
+
 /**********************************************************************/
 
 #endif /* main.h */
@@ -0,0 +1,150 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "simparameters.h"
+#include "main.h"
+#include "metrics.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * Create the shared memory page for the live metrics of a run. Returns NULL
+ * if that isn't possible.
+ */
+
+Metrics_Ptr
+metrics_open(const char * prefix, unsigned random_seed, int number_of_stations)
+{
+#ifndef _WIN32
+  Metrics_Ptr metrics;
+  void * mapping;
+  int fd;
+
+  metrics = (Metrics_Ptr) xcalloc(1, sizeof(Metrics));
+  metrics->size = METRICS_PAGE_SIZE(number_of_stations);
+  snprintf(metrics->name, sizeof(metrics->name), "/%.32s.%ld.%u", prefix,
+	   (long) getpid(), random_seed);
+
+  if ((fd = shm_open(metrics->name, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0 ||
+      ftruncate(fd, (off_t) metrics->size) != 0 ||
+      (mapping = mmap(NULL, metrics->size, PROT_READ | PROT_WRITE,
+		      MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    printf("Warning: Cannot create live metrics page %s\n", metrics->name);
+    if (fd >= 0) {
+      close(fd);
+      shm_unlink(metrics->name);
+    }
+    xfree(metrics);
+    return NULL;
+  }
+  close(fd);
+
+  metrics->page = (Metrics_Page_Ptr) mapping;
+  metrics->page->version = METRICS_VERSION;
+  metrics->page->number_of_stations = number_of_stations;
+  metrics->page->pid = (int64_t) getpid();
+  metrics->page->random_seed = random_seed;
+
+  /* Readers ignore the page until the magic is there. */
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(metrics->page->magic, METRICS_MAGIC, sizeof(metrics->page->magic));
+
+  return metrics;
+#else
+  printf("Warning: Live metrics need POSIX shared memory\n");
+  return NULL;
+#endif
+}
+
+/*
+ * Publish the current state of the simulation_run.
+ */
+
+void
+metrics_publish(Metrics_Ptr metrics, Simulation_Run_Ptr simulation_run)
+{
+#ifndef _WIN32
+  Simulation_Run_Data_Ptr data;
+  Metrics_Page_Ptr page = metrics->page;
+  Station_Ptr station;
+  uint32_t sequence;
+  int i;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  /* Make the sequence odd before changing anything. */
+  sequence = page->sequence;
+  __atomic_store_n(&page->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  page->updates++;
+  page->clock = simulation_run_get_time(simulation_run);
+  page->events = simulation_run->events_executed;
+  page->arrivals = data->arrival_count;
+  page->transmissions = data->packets_transmitted;
+  page->collisions = data->number_of_collisions;
+  page->processed = data->packets_processed;
+  page->mean_delay = data->delay_stats.mean;
+  page->delay_std_dev = sqrt(delay_stats_variance(&data->delay_stats));
+  page->delay_p50 = delay_stats_quantile(&data->delay_stats, 0.5);
+  page->delay_p99 = delay_stats_quantile(&data->delay_stats, 0.99);
+
+  for (i=0; i<NUMBER_OF_STATIONS; i++) {
+    station = data->stations + i;
+    page->stations[i].queue_length = fifoqueue_size(station->buffer);
+    page->stations[i].arrivals = station->arrival_count;
+    page->stations[i].processed = station->packets_processed;
+    page->stations[i].mean_delay = station->delay_stats.mean;
+  }
+
+  /* Even again: the page is consistent. */
+  __atomic_store_n(&page->sequence, sequence + 2, __ATOMIC_RELEASE);
+#endif
+}
+
+/*
+ * Mark the page finished and remove it. Readers that have it mapped still
+ * see the final state.
+ */
+
+void
+metrics_close(Metrics_Ptr metrics)
+{
+#ifndef _WIN32
+  __atomic_store_n(&metrics->page->finished, 1, __ATOMIC_RELEASE);
+  munmap((void *) metrics->page, metrics->size);
+  shm_unlink(metrics->name);
+  xfree(metrics);
+#endif
+}
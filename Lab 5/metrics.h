@@ -0,0 +1,109 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+/*******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************/
+
+/*
+ * Live metrics. A running simulation publishes its state in a page of POSIX
+ * shared memory named "/<prefix>.<pid>.<seed>", which other processes (e.g.,
+ * tools/simstat) can map and read at any time. The page is updated with plain
+ * memory writes, without locks or system calls, using a sequence number: it
+ * is odd while an update is in progress, and a reader retries until it sees
+ * the same even number before and after copying the page. The page is
+ * removed when the run finishes.
+ */
+
+#define METRICS_MAGIC "ALOHAMET"
+#define METRICS_VERSION 1
+
+typedef struct _metrics_station_
+{
+  int64_t queue_length;
+  int64_t arrivals;
+  int64_t processed;
+  double mean_delay;
+} Metrics_Station;
+
+typedef struct _metrics_page_
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t number_of_stations;
+  uint32_t sequence;
+  uint32_t finished;
+  int64_t pid;
+  uint32_t random_seed;
+  uint32_t reserved;
+  uint64_t updates;
+  double clock;
+  int64_t events;
+  int64_t arrivals;
+  int64_t transmissions;
+  int64_t collisions;
+  int64_t processed;
+  double mean_delay;
+  double delay_std_dev;
+  double delay_p50;
+  double delay_p99;
+  Metrics_Station stations[];
+} Metrics_Page, * Metrics_Page_Ptr;
+
+#define METRICS_PAGE_SIZE(number_of_stations) \
+  (sizeof(Metrics_Page) + (number_of_stations) * sizeof(Metrics_Station))
+
+typedef struct _metrics_
+{
+  Metrics_Page_Ptr page;
+  size_t size;
+  char name[64];
+} Metrics, * Metrics_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+struct _simulation_run_;
+
+Metrics_Ptr
+metrics_open(const char *, unsigned, int);
+
+void
+metrics_publish(Metrics_Ptr, struct _simulation_run_ *);
+
+void
+metrics_close(Metrics_Ptr);
+
+/*******************************************************************************/
+
+#endif /* metrics.h */
@@ -23,10 +23,16 @@
 /*******************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include "simparameters.h"
 #include "main.h"
 #include "output.h"
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 /*******************************************************************************/
 
 void
@@ -60,9 +66,401 @@ output_blip_to_screen(Simulation_Run_Ptr simulation_run)
 
 /**********************************************************************/
 
+void
+output_delay_distribution(const char * label, Delay_Stats_Ptr stats)
+{
+  printf("%s Delay: mean = %.2f, std dev = %.2f, "
+	 "p50 = %.2f, p99 = %.2f, p99.9 = %.2f, max = %.2f\n",
+	 label, stats->mean, sqrt(delay_stats_variance(stats)),
+	 delay_stats_quantile(stats, 0.5), delay_stats_quantile(stats, 0.99),
+	 delay_stats_quantile(stats, 0.999), stats->max);
+}
+
+/**********************************************************************/
+
+/*
+ * Time-average occupancies and utilizations. Since every packet in the
+ * system is in a station buffer, the cloud server queue or the cloud
+ * server, Little's law should hold between their total occupancy and the
+ * throughput times the mean delay.
+ */
+
+void
+output_time_averages(Simulation_Run_Ptr this_simulation_run)
+{
+  Simulation_Run_Data_Ptr sim_data;
+  double station_occupancy, packets_in_system, elapsed_time, throughput;
+  int i;
+
+  sim_data = (Simulation_Run_Data_Ptr) simulation_run_data(this_simulation_run);
+
+  packets_in_system = 0.0;
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    station_occupancy =
+      time_average_get((sim_data->stations+i)->buffer->occupancy);
+    packets_in_system += station_occupancy;
+    printf("Station %2i Mean Queue Length = %.3f \n", i, station_occupancy);
+  }
+
+  packets_in_system += time_average_get(sim_data->cloud_server_queue->occupancy)
+    + time_average_get(sim_data->cloud_server->utilization);
+
+  printf("Cloud Mean Queue Length = %.3f \n",
+	 time_average_get(sim_data->cloud_server_queue->occupancy));
+  printf("Cloud Server Utilization = %.4f \n",
+	 time_average_get(sim_data->cloud_server->utilization));
+  printf("Channel Busy = %.4f (Collision = %.4f) \n",
+	 time_average_get(sim_data->channel->busy),
+	 time_average_get(sim_data->channel->collision));
+
+  elapsed_time = simulation_run_get_time(this_simulation_run) -
+    sim_data->cloud_server->utilization->start_time;
+  throughput = elapsed_time > 0.0 ?
+    sim_data->delay_stats.count/elapsed_time : 0.0;
+
+  printf("Little's Law: L = %.3f, lambda*W = %.3f \n",
+	 packets_in_system, throughput * sim_data->delay_stats.mean);
+}
+
+/**********************************************************************/
+
+void
+output_batch_means(Simulation_Run_Ptr this_simulation_run)
+{
+  Simulation_Run_Data_Ptr sim_data;
+  Batch_Means_Ptr batches;
+  Confidence_Interval delay, throughput;
+
+  sim_data = (Simulation_Run_Data_Ptr) simulation_run_data(this_simulation_run);
+  batches = &sim_data->delay_batches;
+
+  delay = batch_means_delay(batches);
+  throughput = batch_means_throughput(batches);
+
+  printf("%s after %ld processed packets\n",
+	 sim_data->stop_run && !sim_data->saturation.saturated ?
+	 "Precision reached" : "Precision NOT reached",
+	 sim_data->packets_processed);
+  printf("Batches = %d of %ld packets (lag-1 autocorrelation = %.3f)\n",
+	 batches->number_of_batches, batches->batch_size,
+	 batch_means_autocorrelation(batches));
+  printf("Batch Mean Delay = %.3f +/- %.3f (95%%)\n",
+	 delay.mean, delay.half_width);
+  printf("Batch Mean Throughput = %.5f +/- %.5f (95%%)\n",
+	 throughput.mean, throughput.half_width);
+}
+
+/**********************************************************************/
+
+/*
+ * If the environment variable ALOHA_TRACE is set, record a binary event
+ * trace of the run in the file it names, with the seed appended. The ring
+ * holds ALOHA_TRACE_RECORDS records if that is set.
+ */
+
+void
+output_open_trace(Simulation_Run_Ptr simulation_run, unsigned random_seed)
+{
+  char file_name[FILENAME_MAX];
+  const char * trace_name, * records;
+  uint64_t capacity = EVENT_TRACE_DEFAULT_RECORDS;
+  Event_Trace_Ptr trace;
+
+  if ((trace_name = getenv("ALOHA_TRACE")) == NULL) return;
+  if ((records = getenv("ALOHA_TRACE_RECORDS")) != NULL)
+    capacity = (uint64_t) strtoul(records, NULL, 10);
+
+  sprintf(file_name, "%.*s.%u", FILENAME_MAX - 16, trace_name, random_seed);
+
+  trace = event_trace_open(file_name, capacity, output_trace_annotate);
+  if (trace != NULL) simulation_run_set_trace(simulation_run, trace);
+}
+
+/*
+ * Fill in the packet, station and channel state of a trace record. Packet
+ * events carry the packet, and cloud server events carry the server. Trace
+ * arrival events carry their arrival trace and have no packet yet.
+ */
+
+void
+output_trace_annotate(Simulation_Run_Ptr simulation_run, void * attachment,
+		      Trace_Record_Ptr record)
+{
+  Simulation_Run_Data_Ptr data;
+  Arrival_Trace_Ptr trace;
+  Packet_Ptr packet;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  record->channel_state = (int8_t) get_channel_state(data->channel);
+
+  if (attachment == NULL) return;
+
+  for (trace = data->arrival_traces; trace != NULL; trace = trace->next_trace)
+    if (attachment == (void *) trace) return;
+
+  if (attachment == (void *) data->cloud_server) {
+    packet = (Packet_Ptr) data->cloud_server->customer_in_service;
+  } else {
+    packet = (Packet_Ptr) attachment;
+  }
+
+  if (packet != NULL) {
+    record->packet_id = packet->id;
+    record->station_id = packet->station_id;
+  }
+}
+
+/*
+ * If the environment variable ALOHA_PACKET_EXPORT is set, export every
+ * processed packet to the file it names, with the seed appended.
+ */
+
+Packet_Export_Ptr
+output_open_packet_export(unsigned random_seed)
+{
+  char file_name[FILENAME_MAX];
+  const char * export_name;
+
+  if ((export_name = getenv("ALOHA_PACKET_EXPORT")) == NULL) return NULL;
+
+  sprintf(file_name, "%.*s.%u", FILENAME_MAX - 16, export_name, random_seed);
+  return packet_export_open(file_name);
+}
+
+/*
+ * If the environment variable ALOHA_PROFILE is set, profile the event list
+ * and print the profile with the results.
+ */
+
+void
+output_open_profile(Simulation_Run_Ptr simulation_run)
+{
+  if (getenv("ALOHA_PROFILE") == NULL) return;
+  simulation_run_set_profile(simulation_run, event_profile_new());
+}
+
+/*
+ * If the environment variable ALOHA_PERF is set, count hardware events
+ * during the main event loop.
+ */
+
+Perf_Counters_Ptr
+output_open_perf_counters(void)
+{
+  if (getenv("ALOHA_PERF") == NULL) return NULL;
+  return perf_counters_open();
+}
+
+/*
+ * If the environment variable ALOHA_METRICS is set, publish live metrics in
+ * shared memory, named with its value as the prefix.
+ */
+
+Metrics_Ptr
+output_open_metrics(unsigned random_seed)
+{
+  const char * prefix;
+
+  if ((prefix = getenv("ALOHA_METRICS")) == NULL) return NULL;
+  return metrics_open(prefix, random_seed, NUMBER_OF_STATIONS);
+}
+
+/*
+ * If the environment variable ALOHA_WARM_START is set, start each run from a
+ * snapshot in the warm-start file it names.
+ */
+
+Warm_Start_Ptr
+output_open_warm_start(void)
+{
+  const char * file_name;
+
+  if ((file_name = getenv("ALOHA_WARM_START")) == NULL) return NULL;
+  return warm_start_load(file_name);
+}
+
+/*
+ * If the environment variable ALOHA_WARM_START_SAVE is set, record snapshots
+ * of every run in the warm-start file it names.
+ */
+
+Warm_Start_Ptr
+output_open_warm_start_recorder(void)
+{
+  const char * file_name;
+
+  if ((file_name = getenv("ALOHA_WARM_START_SAVE")) == NULL) return NULL;
+  return warm_start_record(file_name);
+}
+
+/*
+ * One line summary of a run for benchmark scripts: the parameters, events
+ * executed per CPU second, the peak resident memory (in kB, -1 where unknown)
+ * and the largest size the event list reached.
+ */
+
+void
+output_benchmark_summary(Simulation_Run_Ptr simulation_run, double cpu_seconds)
+{
+  long int peak_rss = -1;
+  Simulation_Run_Data_Ptr data;
+  long int events = simulation_run->events_executed;
+#ifndef _WIN32
+  struct rusage usage;
+#endif
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+#ifndef _WIN32
+
+  if (getrusage(RUSAGE_SELF, &usage) == 0) peak_rss = usage.ru_maxrss;
+#endif
+
+  printf("Benchmark: stations=%d arrival_rate=%g mean_backoff=%g events=%ld "
+	 "cpu_seconds=%.3f events_per_sec=%.0f peak_rss_kb=%ld "
+	 "eventlist_hwm=%d\n", NUMBER_OF_STATIONS,
+	 (double) PACKET_ARRIVAL_RATE, data->mean_backoff_duration, events,
+	 cpu_seconds, cpu_seconds > 0 ? events/cpu_seconds : 0.0, peak_rss,
+	 simulation_run->eventlist->max_size);
+}
+
+/*
+ * The heap accounts kept by xmalloc and xfree. Live is what is still
+ * allocated now; peak is the most that was ever allocated at once.
+ */
+
+void
+output_memory_usage(void)
+{
+  Memory_Usage usage;
+  int tag;
+
+  printf("Memory (bytes)     live        peak  allocations\n");
+  for (tag = 0; tag <= MEMORY_TOTAL; tag++) {
+    usage = memory_usage((Memory_Tag) tag);
+    printf("  %-9s %11ld %11ld %12ld\n", memory_tag_name((Memory_Tag) tag),
+	   usage.live, usage.peak, usage.allocations);
+  }
+}
+
+/*
+ * The mean delay from the batches of the control variates, plain and
+ * adjusted. Replayed arrivals have no known means to adjust with.
+ */
+
+void
+output_control_variates(Simulation_Run_Ptr this_simulation_run)
+{
+  Simulation_Run_Data_Ptr sim_data;
+  Control_Variate_Estimate estimate;
+  int k;
+
+  sim_data = (Simulation_Run_Data_Ptr) simulation_run_data(this_simulation_run);
+
+  if (sim_data->arrival_traces != NULL) {
+    printf("Control variates are not used with arrival traces\n");
+    return;
+  }
+
+  estimate = control_variates_estimate(&sim_data->control_variates);
+
+  printf("Plain Mean Delay = %.3f +/- %.3f (95%%, %d batches of %ld packets)\n",
+	 estimate.plain.mean, estimate.plain.half_width,
+	 sim_data->control_variates.number_of_batches,
+	 sim_data->control_variates.batch_size);
+  printf("Control Variate Mean Delay = %.3f +/- %.3f (95%%)\n",
+	 estimate.adjusted.mean, estimate.adjusted.half_width);
+  for (k=0; k<CONTROLS; k++) {
+    if (estimate.used[k])
+      printf("  control %-12s beta = %.4f\n", control_name((Control) k),
+	     estimate.beta[k]);
+  }
+}
+
+/*
+ * The ratio estimates from regenerative cycles.
+ */
+
+void
+output_regenerative(Regenerative_Ptr regeneration)
+{
+  Confidence_Interval delay, throughput;
+
+  if (regeneration->cycles < 2) {
+    printf("Regenerative: %ld complete cycles, too few for an estimate\n",
+	   regeneration->cycles);
+    return;
+  }
+
+  delay = regenerative_delay(regeneration);
+  throughput = regenerative_throughput(regeneration);
+  printf("Regenerative Mean Delay = %.3f +/- %.3f (95%%, %ld cycles)\n",
+	 delay.mean, delay.half_width, regeneration->cycles);
+  printf("Regenerative Throughput = %.5f +/- %.5f (95%%)\n",
+	 throughput.mean, throughput.half_width);
+  printf("Mean Cycle = %.2f packets in %.2f time units\n",
+	 regeneration->mean[CYCLE_PACKETS], regeneration->mean[CYCLE_LENGTH]);
+}
+
+/*
+ * The delay tail from RESTART splitting, with the crude estimate from the
+ * main trial alone for comparison.
+ */
+
+void
+output_restart(Restart_Ptr restart)
+{
+  Confidence_Interval tail;
+  long int packets = 0;
+  int i;
+
+  tail = restart_tail_probability(restart);
+  for (i=0; i<RESTART_BATCHES; i++) packets += restart->main_packets[i];
+
+  if (tail.mean > 0.0) {
+    printf("RESTART P(delay > %g) = %.3e +/- %.3e (95%%, relative error "
+	   "%.1f%%)\n", (double) TAIL_DELAY_THRESHOLD, tail.mean,
+	   tail.half_width, 100.0*tail.half_width/tail.mean);
+  } else {
+    printf("RESTART P(delay > %g) = 0 (no trial reached it)\n",
+	   (double) TAIL_DELAY_THRESHOLD);
+  }
+  printf("Crude P(delay > %g) = %.3e (%ld of %ld packets in the main trial)\n",
+	 (double) TAIL_DELAY_THRESHOLD,
+	 packets > 0 ? (double) restart->main_tail_packets/packets : 0.0,
+	 restart->main_tail_packets, packets);
+  for (i=1; i<=restart->levels; i++)
+    printf("  level %d: importance %g, %d splits, %ld retrials\n", i,
+	   restart->threshold[i], restart->splits[i], restart->retrials[i]);
+  printf("  %ld events in all trials\n", restart->events);
+}
+
+/*
+ * The mean delay over antithetic pairs. Each pair's estimate is the average
+ * of a run and its antithetic run, which are negatively correlated, so the
+ * pair estimates vary less than independent runs would.
+ */
+
+void
+output_antithetic_pairs(double * pair_delays, int pairs)
+{
+  Confidence_Interval delay;
+
+  if (pairs == 1) {
+    printf("Antithetic Pairs: mean delay = %.3f (1 pair)\n", pair_delays[0]);
+    return;
+  }
+  delay = confidence_interval(pair_delays, pairs);
+  printf("Antithetic Pairs: mean delay = %.3f +/- %.3f (95%%, %d pairs)\n",
+	 delay.mean, delay.half_width, pairs);
+}
+
+/**********************************************************************/
+
 void output_results(Simulation_Run_Ptr this_simulation_run)
 {
   int i;
+  char label[32];
   double xmtted_fraction;
   Simulation_Run_Data_Ptr sim_data;
 
@@ -70,6 +468,9 @@ void output_results(Simulation_Run_Ptr this_simulation_run)
 
   printf("\n");
   printf("Random Seed = %d \n", sim_data->random_seed);
+#if ANTITHETIC_PAIRS
+  printf("Antithetic = %s \n", sim_data->antithetic ? "yes" : "no");
+#endif
   printf("Pkt Arrivals = %ld \n", sim_data->arrival_count);
   printf("Pkt Transmits = %ld \n", sim_data->packets_transmitted);
   printf("Pkt Processed = %ld \n", sim_data->packets_processed);
@@ -89,6 +490,26 @@ void output_results(Simulation_Run_Ptr this_simulation_run)
 	 (double) sim_data->number_of_collisions / 
 	 sim_data->packets_processed);
 
+#if STATION_BUFFER_CAPACITY > 0
+  printf("Pkt Dropped = %ld (Loss Fraction = %.5f)\n",
+	 sim_data->packets_dropped,
+	 (double) sim_data->packets_dropped / sim_data->arrival_count);
+#endif
+
+#if SATURATION_DETECTION
+  if (sim_data->saturation.saturated) {
+    printf("SATURATED: stopped at time %.1f, the backlog grew by %.3f "
+	   "packets per arrival for %d windows of %d arrivals. The statistics "
+	   "are partial.\n", sim_data->saturation.saturation_time,
+	   sim_data->saturation.drift, SATURATION_WINDOWS, SATURATION_WINDOW);
+  } else {
+    printf("Not saturated (backlog drift = %.4f packets per arrival)\n",
+	   sim_data->saturation.drift);
+  }
+#endif
+
+  output_delay_distribution("Overall", &sim_data->delay_stats);
+
   for(i=0; i<NUMBER_OF_STATIONS; i++) {
 
     printf("Station %2i Pkt Arrivals = %ld \n", i,
@@ -103,13 +524,57 @@ void output_results(Simulation_Run_Ptr this_simulation_run)
     printf("Station %2i Pkt Collisions = %ld \n", i,
         (sim_data->stations + i)->number_of_collisions);
 
+#if STATION_BUFFER_CAPACITY > 0
+    printf("Station %2i Pkt Dropped = %ld \n", i,
+        (sim_data->stations + i)->packets_dropped);
+#endif
+
     printf("Station %2i Accumulated Delay = %8.1f \n", i,
         (sim_data->stations + i)->accumulated_delay);
 
     printf("Station %2i Mean Delay = %8.1f \n", i,
 	   (sim_data->stations+i)->accumulated_delay / 
 	   (sim_data->stations+i)->packets_processed);
+
+    sprintf(label, "Station %2i", i);
+    output_delay_distribution(label, &(sim_data->stations+i)->delay_stats);
+  }
+
+  output_time_averages(this_simulation_run);
+
+#if WARMUP_DETECTION
+  if (sim_data->warmup.done) {
+    printf("Warm-up truncated at time %.1f after %ld packets "
+	   "(MSER batch %d of %ld packets)\n",
+	   sim_data->warmup.truncation_time,
+	   sim_data->warmup.truncated_packets,
+	   sim_data->warmup.truncation_batch, sim_data->warmup.batch_size);
+  } else {
+    printf("Warm-up NOT detected, statistics include the initial transient\n");
   }
+#endif
+
+#if SEQUENTIAL_STOPPING
+  output_batch_means(this_simulation_run);
+#endif
+
+#if CONTROL_VARIATES
+  output_control_variates(this_simulation_run);
+#endif
+
+#if REGENERATIVE_ESTIMATION
+  if (sim_data->arrival_traces != NULL)
+    printf("Regenerative estimates are not used with arrival traces\n");
+  else output_regenerative(&sim_data->regeneration);
+#endif
+
+#if MEMORY_REPORT
+  output_memory_usage();
+#endif
+
+  if (this_simulation_run->profile != NULL)
+    event_profile_print(this_simulation_run->profile, stdout);
+
   printf("\n\n");
 }
 
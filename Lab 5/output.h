@@ -28,6 +28,11 @@
 /*******************************************************************************/
 
 #include "trace.h"
+#include "event_trace.h"
+#include "event_profile.h"
+#include "perf_counters.h"
+#include "warm_start.h"
+#include "restart.h"
 #include "main.h"
 
 /*******************************************************************************/
@@ -42,6 +47,57 @@ output_blip_to_screen(Simulation_Run_Ptr);
 void
 output_results(Simulation_Run_Ptr);
 
+void
+output_batch_means(Simulation_Run_Ptr);
+
+void
+output_delay_distribution(const char *, Delay_Stats_Ptr);
+
+void
+output_time_averages(Simulation_Run_Ptr);
+
+void
+output_memory_usage(void);
+
+void
+output_antithetic_pairs(double *, int);
+
+void
+output_control_variates(Simulation_Run_Ptr);
+
+void
+output_regenerative(Regenerative_Ptr);
+
+void
+output_restart(Restart_Ptr);
+
+void
+output_open_trace(Simulation_Run_Ptr, unsigned);
+
+void
+output_trace_annotate(Simulation_Run_Ptr, void *, Trace_Record_Ptr);
+
+Packet_Export_Ptr
+output_open_packet_export(unsigned);
+
+void
+output_open_profile(Simulation_Run_Ptr);
+
+void
+output_benchmark_summary(Simulation_Run_Ptr, double);
+
+Perf_Counters_Ptr
+output_open_perf_counters(void);
+
+Metrics_Ptr
+output_open_metrics(unsigned);
+
+Warm_Start_Ptr
+output_open_warm_start(void);
+
+Warm_Start_Ptr
+output_open_warm_start_recorder(void);
+
 /*******************************************************************************/
 
 #endif /* output.h */
@@ -24,15 +24,28 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "packet_duration.h"
 #include "packet_transmission.h"
 #include "packet_arrival.h"
+#include "random_streams.h"
 
 /*******************************************************************************/
 
-long int
-schedule_packet_arrival_event(Simulation_Run_Ptr simulation_run,
-			      Time event_time)
+static void
+check_saturation(Simulation_Run_Ptr);
+
+/*******************************************************************************/
+
+/*
+ * Packet arrivals are an event source rather than events on the event list.
+ * Interarrival times are exponential, and pre-generated ARRIVAL_BLOCK_SIZE
+ * at a time if that is greater than one.
+ */
+
+Event_Source_Ptr
+packet_arrival_source_new(Simulation_Run_Ptr simulation_run)
 {
   Event event;
 
@@ -40,7 +53,10 @@ schedule_packet_arrival_event(Simulation_Run_Ptr simulation_run,
   event.function = packet_arrival_event;
   event.attachment = NULL;
 
-  return simulation_run_schedule_event(simulation_run, event, event_time);
+  return simulation_run_add_source(simulation_run, event,
+				   exponential_generator,
+				   (double) 1/PACKET_ARRIVAL_RATE,
+				   ARRIVAL_BLOCK_SIZE);
 }
 
 /******************************************************************************
@@ -51,40 +67,91 @@ single base station
 void
 packet_arrival_event(Simulation_Run_Ptr simulation_run, void* dummy_ptr) 
 {
-  int random_station_id;
-  Station_Ptr station;
-  Packet_Ptr new_packet;
-  Buffer_Ptr stn_buffer;
-  Time now;
   Simulation_Run_Data_Ptr data;
-
-  now = simulation_run_get_time(simulation_run);
+  int random_station_id;
+  double upload_time;
 
   data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
-  data->arrival_count++;
 
   /* Randomly pick the mobile device that this packet is arriving to. Note
      that randomly splitting a Poisson process creates multiple
      independent Poisson processes.*/
-  random_station_id = (int) floor(uniform_generator()*NUMBER_OF_STATIONS);
-  station = data->stations + random_station_id;
-
-  new_packet = (Packet_Ptr) xmalloc(sizeof(Packet));
-  new_packet->arrive_time = now;
-  new_packet->service_time = get_packet_duration();
-  new_packet->status = WAITING;
-  new_packet->collision_count = 0;
-  new_packet->station_id = random_station_id;
+  random_station_id =
+    (int) floor(random_station_uniform(data)*NUMBER_OF_STATIONS);
 
   /* Depending on the mobile device it sends to, either upload duration of U or U*10 */
   if (random_station_id == 0) {
-      new_packet->upload_time = get_packet_upload_duration();
+      upload_time = get_packet_upload_duration();
   }
   else {
-      new_packet->upload_time = get_packet_upload_duration()*10;
+      upload_time = get_packet_upload_duration()*10;
   }
 
-  (data->stations + new_packet->station_id)->arrival_count++;
+  packet_arrival(simulation_run, random_station_id, upload_time,
+		 get_packet_duration());
+
+  /* Schedule the next packet arrival. */
+  event_source_schedule_next(simulation_run, data->arrival_source);
+}
+
+/*
+ * A packet arrives now at a mobile device. Put it in the device's buffer, and
+ * start transmitting it if it is the only one there.
+ */
+
+void
+packet_arrival(Simulation_Run_Ptr simulation_run, int station_id,
+	       double upload_time, double service_time)
+{
+  Station_Ptr station;
+  Packet_Ptr new_packet;
+  Buffer_Ptr stn_buffer;
+  Time now, last_arrival_time;
+  Simulation_Run_Data_Ptr data;
+
+  now = simulation_run_get_time(simulation_run);
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  COUNTER_INCREMENT(data->arrival_count);
+
+  station = data->stations + station_id;
+  station->arrival_count++;
+
+  /* The interarrival time is measured from the last arrival, dropped or not. */
+  last_arrival_time = data->last_arrival_time;
+  data->last_arrival_time = now;
+
+#if REGENERATIVE
+  /* An arrival to an empty system starts a new regenerative cycle. */
+  if (data->packets_in_system == 0 &&
+      regenerative_epoch(&data->regeneration, now))
+    data->stop_run = 1;
+#endif
+
+#if STATION_BUFFER_CAPACITY > 0
+  /* A full buffer turns the packet away. */
+  if (fifoqueue_size(station->buffer) >= STATION_BUFFER_CAPACITY) {
+    data->packets_dropped++;
+    station->packets_dropped++;
+    check_saturation(simulation_run);
+    return;
+  }
+#endif
+
+  new_packet = (Packet_Ptr) xmalloc_tagged(sizeof(Packet), MEMORY_PACKETS);
+  new_packet->id = data->next_packet_id++;
+  new_packet->arrive_time = now;
+  new_packet->first_transmit_time = -1.0;
+  new_packet->success_time = -1.0;
+  new_packet->cloud_start_time = -1.0;
+  new_packet->service_time = service_time;
+  new_packet->upload_time = upload_time;
+  new_packet->status = WAITING;
+  new_packet->collision_count = 0;
+  new_packet->backoff_excess = 0.0;
+  new_packet->station_id = station_id;
+  new_packet->interarrival_time = now - last_arrival_time;
+  data->packets_in_system++;
 
   /* Put the packet in the buffer at the mobile device. */
   stn_buffer = station->buffer;
@@ -97,7 +164,115 @@ packet_arrival_event(Simulation_Run_Ptr simulation_run, void* dummy_ptr)
     schedule_transmission_start_event(simulation_run, now, (void *) new_packet);
   }
 
-  /* Schedule the next packet arrival. */
-  schedule_packet_arrival_event(simulation_run, 
-		now + exponential_generator((double) 1/PACKET_ARRIVAL_RATE));
+  check_saturation(simulation_run);
+}
+
+/******************************************************************************
+If the backlog has kept growing, give up on the run: it would never reach
+RUNLENGTH processed packets in any reasonable time.
+*/
+
+static void
+check_saturation(Simulation_Run_Ptr simulation_run)
+{
+#if SATURATION_DETECTION
+  Simulation_Run_Data_Ptr data;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  if (saturation_detector_add(&data->saturation, data->packets_in_system,
+			      simulation_run_get_time(simulation_run)))
+    data->stop_run = 1;
+#else
+  (void) simulation_run;
+#endif
+}
+
+/******************************************************************************
+Trace-driven arrivals. If the environment variable ALOHA_ARRIVAL_TRACE is set,
+arrivals are replayed from the comma-separated list of trace files it names
+instead of being generated. Returns the number of traces opened.
+*/
+
+int
+schedule_trace_arrivals(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  Arrival_Trace_Ptr trace;
+  Event event;
+  const char * names;
+  char name[FILENAME_MAX];
+  size_t length;
+  int count = 0;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  data->arrival_traces = NULL;
+
+  if ((names = getenv("ALOHA_ARRIVAL_TRACE")) == NULL) return 0;
+
+  while (*names != '\0') {
+    length = strcspn(names, ",");
+    if (length > 0 && length < sizeof(name)) {
+      memcpy(name, names, length);
+      name[length] = '\0';
+
+      if ((trace = arrival_trace_open(name)) != NULL) {
+	trace->next_trace = data->arrival_traces;
+	data->arrival_traces = trace;
+
+	event.description = "Trace Packet Arrival";
+	event.function = trace_arrival_event;
+	event.attachment = (void *) trace;
+	trace->source = simulation_run_add_source(simulation_run, event,
+						  NULL, 0.0, 0);
+	schedule_trace_arrival_event(simulation_run, trace);
+	count++;
+      }
+    }
+    names += length;
+    if (*names == ',') names++;
+  }
+
+  if (count == 0) {
+    printf("Error: No usable arrival traces in ALOHA_ARRIVAL_TRACE\n");
+    exit(1);
+  }
+  return count;
+}
+
+/******************************************************************************
+Each arrival trace is an event source. Its next arrival is scheduled when
+the previous one occurs.
+*/
+
+long int
+schedule_trace_arrival_event(Simulation_Run_Ptr simulation_run,
+			     Arrival_Trace_Ptr trace)
+{
+  const Arrival_Record * record;
+
+  /* The trace is finished once it runs out of records. */
+  if ((record = arrival_trace_next(trace)) == NULL) return 0;
+
+  if (record->station_id < 0 || record->station_id >= NUMBER_OF_STATIONS) {
+    printf("Error: Arrival trace record %lu is for station %d\n",
+	   (unsigned long) trace->next - 1, (int) record->station_id);
+    exit(1);
+  }
+
+  /* The record is read again when the arrival occurs. */
+  trace->current = record;
+  return event_source_schedule(simulation_run, trace->source, record->time);
+}
+
+void
+trace_arrival_event(Simulation_Run_Ptr simulation_run, void * ptr)
+{
+  Arrival_Trace_Ptr trace = (Arrival_Trace_Ptr) ptr;
+  const Arrival_Record * record = trace->current;
+
+  packet_arrival(simulation_run, record->station_id, record->upload_time,
+		 record->service_time);
+
+  schedule_trace_arrival_event(simulation_run, trace);
 }
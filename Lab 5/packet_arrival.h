@@ -26,6 +26,11 @@
 
 /*******************************************************************************/
 
+#include "main.h"
+#include "arrival_trace.h"
+
+/*******************************************************************************/
+
 /*
  * Function prototypes
  */
@@ -33,8 +38,20 @@
 void
 packet_arrival_event(Simulation_Run_Ptr, void *);
 
+Event_Source_Ptr
+packet_arrival_source_new(Simulation_Run_Ptr);
+
+void
+packet_arrival(Simulation_Run_Ptr, int, double, double);
+
+void
+trace_arrival_event(Simulation_Run_Ptr, void *);
+
 long int
-schedule_packet_arrival_event(Simulation_Run_Ptr, Time);
+schedule_trace_arrival_event(Simulation_Run_Ptr, Arrival_Trace_Ptr);
+
+int
+schedule_trace_arrivals(Simulation_Run_Ptr);
 
 /*******************************************************************************/
 
@@ -0,0 +1,271 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "packet_export.h"
+
+/*******************************************************************************/
+
+static const struct
+{
+  char name[16];
+  char type[4];
+} columns[PACKET_EXPORT_COLUMNS] = {
+  {"id", "i64"},
+  {"station_id", "i32"},
+  {"attempts", "i32"},
+  {"arrive_time", "f64"},
+  {"first_transmit", "f64"},
+  {"success_time", "f64"},
+  {"cloud_start", "f64"},
+  {"cloud_end", "f64"},
+};
+
+/*
+ * Write a block to the file. Columns are written one after the other. Once a
+ * write has failed, e.g., because the disk is full, nothing more is written
+ * and the export is reported as incomplete when it is closed.
+ */
+
+static void
+packet_export_write_block(Packet_Export_Ptr exporter,
+			  Packet_Export_Block_Ptr block)
+{
+  uint32_t block_header[2];
+  FILE * fp = exporter->fp;
+  size_t n;
+
+  n = block->rows;
+  block_header[0] = block->rows;
+  block_header[1] = block->attempt_rows;
+
+  if (!exporter->failed &&
+      (fwrite(block_header, sizeof(block_header), 1, fp) != 1 ||
+       fwrite(block->id, sizeof(block->id[0]), n, fp) != n ||
+       fwrite(block->station_id, sizeof(block->station_id[0]), n, fp) != n ||
+       fwrite(block->attempts, sizeof(block->attempts[0]), n, fp) != n ||
+       fwrite(block->arrive_time, sizeof(double), n, fp) != n ||
+       fwrite(block->first_transmit_time, sizeof(double), n, fp) != n ||
+       fwrite(block->success_time, sizeof(double), n, fp) != n ||
+       fwrite(block->cloud_start_time, sizeof(double), n, fp) != n ||
+       fwrite(block->cloud_end_time, sizeof(double), n, fp) != n ||
+       fwrite(block->attempt_id, sizeof(block->attempt_id[0]),
+	      block->attempt_rows, fp) != block->attempt_rows ||
+       fwrite(block->attempt_time, sizeof(double),
+	      block->attempt_rows, fp) != block->attempt_rows)) {
+    exporter->failed = 1;
+  }
+
+  block->rows = 0;
+  block->attempt_rows = 0;
+}
+
+#ifndef _WIN32
+
+/*
+ * The writer thread writes each pending block, then waits for the next one,
+ * until the export is closed.
+ */
+
+static void *
+packet_export_writer(void * arg)
+{
+  Packet_Export_Ptr exporter = (Packet_Export_Ptr) arg;
+
+  pthread_mutex_lock(&exporter->lock);
+  for (;;) {
+    while (exporter->pending == NULL && !exporter->closing)
+      pthread_cond_wait(&exporter->changed, &exporter->lock);
+
+    if (exporter->pending == NULL) break;
+
+    pthread_mutex_unlock(&exporter->lock);
+    packet_export_write_block(exporter, exporter->pending);
+    pthread_mutex_lock(&exporter->lock);
+
+    exporter->pending = NULL;
+    pthread_cond_broadcast(&exporter->changed);
+  }
+  pthread_mutex_unlock(&exporter->lock);
+  return NULL;
+}
+
+#endif /* _WIN32 */
+
+/*
+ * Hand the block being filled to the writer and start filling the other one.
+ */
+
+static void
+packet_export_flush(Packet_Export_Ptr exporter)
+{
+  if (!exporter->threaded) {
+    packet_export_write_block(exporter, exporter->filling);
+    return;
+  }
+
+#ifndef _WIN32
+  pthread_mutex_lock(&exporter->lock);
+  while (exporter->pending != NULL)
+    pthread_cond_wait(&exporter->changed, &exporter->lock);
+
+  exporter->pending = exporter->filling;
+  exporter->filling = exporter->filling == exporter->block[0] ?
+    exporter->block[1] : exporter->block[0];
+
+  pthread_cond_broadcast(&exporter->changed);
+  pthread_mutex_unlock(&exporter->lock);
+#endif
+}
+
+/*
+ * Create an export file. Returns NULL (after printing a warning) if the file
+ * can't be created.
+ */
+
+Packet_Export_Ptr
+packet_export_open(const char * file_name)
+{
+  Packet_Export_Ptr exporter;
+  uint32_t file_header[2];
+  FILE * fp;
+
+  if ((fp = fopen(file_name, "wb")) == NULL) {
+    printf("Warning: Cannot create packet export file %s\n", file_name);
+    return NULL;
+  }
+
+  file_header[0] = PACKET_EXPORT_VERSION;
+  file_header[1] = PACKET_EXPORT_COLUMNS;
+  if (fwrite(PACKET_EXPORT_MAGIC, 8, 1, fp) != 1 ||
+      fwrite(file_header, sizeof(file_header), 1, fp) != 1 ||
+      fwrite(columns, sizeof(columns), 1, fp) != 1) {
+    printf("Warning: Cannot write packet export file %s\n", file_name);
+    fclose(fp);
+    return NULL;
+  }
+
+  exporter = (Packet_Export_Ptr) xcalloc(1, sizeof(Packet_Export));
+  exporter->fp = fp;
+  strncpy(exporter->file_name, file_name, sizeof(exporter->file_name) - 1);
+  exporter->failed = 0;
+  exporter->block[0] = (Packet_Export_Block_Ptr)
+    xcalloc(1, sizeof(Packet_Export_Block));
+  exporter->block[1] = (Packet_Export_Block_Ptr)
+    xcalloc(1, sizeof(Packet_Export_Block));
+  exporter->filling = exporter->block[0];
+  exporter->pending = NULL;
+  exporter->closing = 0;
+  exporter->threaded = 0;
+
+#ifndef _WIN32
+  pthread_mutex_init(&exporter->lock, NULL);
+  pthread_cond_init(&exporter->changed, NULL);
+  if (pthread_create(&exporter->writer, NULL, packet_export_writer,
+		     (void *) exporter) == 0) {
+    exporter->threaded = 1;
+  } else {
+    printf("Warning: No writer thread for packet export file %s\n",
+	   file_name);
+  }
+#endif
+
+  return exporter;
+}
+
+/*
+ * Add a packet that has just finished processing at time now.
+ */
+
+void
+packet_export_add(Packet_Export_Ptr exporter, void * ptr, double now)
+{
+  Packet_Ptr packet = (Packet_Ptr) ptr;
+  Packet_Export_Block_Ptr block = exporter->filling;
+  uint32_t row = block->rows;
+
+  block->id[row] = packet->id;
+  block->station_id[row] = packet->station_id;
+  block->attempts[row] = packet->collision_count + 1;
+  block->arrive_time[row] = packet->arrive_time;
+  block->first_transmit_time[row] = packet->first_transmit_time;
+  block->success_time[row] = packet->success_time;
+  block->cloud_start_time[row] = packet->cloud_start_time;
+  block->cloud_end_time[row] = now;
+
+  if (++block->rows == PACKET_EXPORT_BLOCK_ROWS) packet_export_flush(exporter);
+}
+
+/*
+ * Add a transmission attempt of a packet, starting at time now.
+ */
+
+void
+packet_export_attempt(Packet_Export_Ptr exporter, void * ptr, double now)
+{
+  Packet_Ptr packet = (Packet_Ptr) ptr;
+  Packet_Export_Block_Ptr block = exporter->filling;
+  uint32_t row = block->attempt_rows;
+
+  block->attempt_id[row] = packet->id;
+  block->attempt_time[row] = now;
+
+  if (++block->attempt_rows == PACKET_EXPORT_BLOCK_ROWS)
+    packet_export_flush(exporter);
+}
+
+/*
+ * Write out whatever is left, stop the writer and close the file.
+ */
+
+void
+packet_export_close(Packet_Export_Ptr exporter)
+{
+  if (exporter->filling->rows > 0 || exporter->filling->attempt_rows > 0)
+    packet_export_flush(exporter);
+
+#ifndef _WIN32
+  if (exporter->threaded) {
+    pthread_mutex_lock(&exporter->lock);
+    exporter->closing = 1;
+    pthread_cond_broadcast(&exporter->changed);
+    pthread_mutex_unlock(&exporter->lock);
+
+    pthread_join(exporter->writer, NULL);
+  }
+  pthread_mutex_destroy(&exporter->lock);
+  pthread_cond_destroy(&exporter->changed);
+#endif
+
+  if (fclose(exporter->fp) != 0 || exporter->failed) {
+    printf("Warning: Writing packet export file %s failed, so it is "
+	   "incomplete\n", exporter->file_name);
+  }
+  xfree(exporter->block[0]);
+  xfree(exporter->block[1]);
+  xfree(exporter);
+}
+
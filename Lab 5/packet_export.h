@@ -0,0 +1,120 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _PACKET_EXPORT_H_
+#define _PACKET_EXPORT_H_
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * Columnar per-packet export. The life of every processed packet is appended
+ * to a block of column buffers. Full blocks are handed to a writer thread,
+ * while the simulation fills the other block, so the simulation only waits if
+ * the disk falls a whole block behind. If the writer thread can't be started,
+ * full blocks are written by the simulation itself.
+ *
+ * Every transmission attempt is also exported, as a second stream of (packet
+ * id, start time) rows, appended when the attempt starts. Each block carries
+ * the attempts made since the previous one, so a packet's attempts are in the
+ * same block as the packet or in earlier ones.
+ *
+ * File layout (native byte order):
+ *
+ *   header:  "ALOHAPKT", uint32 version, uint32 number of columns, then for
+ *            each column a 16-byte name and a 4-byte type ("i64", "i32" or
+ *            "f64")
+ *   blocks:  uint32 rows, uint32 attempt rows, then each column in turn as
+ *            rows consecutive values, then the attempts' packet ids (i64) and
+ *            times (f64) as attempt rows consecutive values each
+ */
+
+#define PACKET_EXPORT_MAGIC "ALOHAPKT"
+#define PACKET_EXPORT_VERSION 2
+#define PACKET_EXPORT_COLUMNS 8
+#define PACKET_EXPORT_BLOCK_ROWS 65536
+
+typedef struct _packet_export_block_
+{
+  uint32_t rows;
+  int64_t id[PACKET_EXPORT_BLOCK_ROWS];
+  int32_t station_id[PACKET_EXPORT_BLOCK_ROWS];
+  int32_t attempts[PACKET_EXPORT_BLOCK_ROWS];
+  double arrive_time[PACKET_EXPORT_BLOCK_ROWS];
+  double first_transmit_time[PACKET_EXPORT_BLOCK_ROWS];
+  double success_time[PACKET_EXPORT_BLOCK_ROWS];
+  double cloud_start_time[PACKET_EXPORT_BLOCK_ROWS];
+  double cloud_end_time[PACKET_EXPORT_BLOCK_ROWS];
+  uint32_t attempt_rows;
+  int64_t attempt_id[PACKET_EXPORT_BLOCK_ROWS];
+  double attempt_time[PACKET_EXPORT_BLOCK_ROWS];
+} Packet_Export_Block, * Packet_Export_Block_Ptr;
+
+typedef struct _packet_export_
+{
+  FILE * fp;
+  char file_name[FILENAME_MAX];
+  int failed;
+  Packet_Export_Block_Ptr block[2];
+  Packet_Export_Block_Ptr filling;
+  Packet_Export_Block_Ptr pending;
+  int closing;
+  int threaded;
+#ifndef _WIN32
+  pthread_t writer;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+#endif
+} Packet_Export, * Packet_Export_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Packet_Export_Ptr
+packet_export_open(const char *);
+
+void
+packet_export_add(Packet_Export_Ptr, void *, double);
+
+void
+packet_export_attempt(Packet_Export_Ptr, void *, double);
+
+void
+packet_export_close(Packet_Export_Ptr);
+
+/*******************************************************************************/
+
+#endif /* packet_export.h */
+
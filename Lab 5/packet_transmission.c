@@ -27,6 +27,8 @@
 #include "trace.h"
 #include "output.h"
 #include "channel.h"
+#include "statistics.h"
+#include "random_streams.h"
 #include "packet_transmission.h"
 
 /****************************************************************************************************************
@@ -62,6 +64,13 @@ transmission_start_event(Simulation_Run_Ptr simulation_run, void * ptr)
   increment_transmitting_stn_count(channel);
   this_packet->status = TRANSMITTING;
 
+  if (this_packet->collision_count == 0)
+    this_packet->first_transmit_time = simulation_run_get_time(simulation_run);
+
+  if (data->packet_export != NULL)
+    packet_export_attempt(data->packet_export, (void *) this_packet,
+			  simulation_run_get_time(simulation_run));
+
   if(get_channel_state(channel) != IDLE) {
     /* The channel is now colliding. */
     set_channel_state(channel, COLLISION);
@@ -119,14 +128,17 @@ transmission_end_event(Simulation_Run_Ptr simulation_run, void* packet)
     if (get_channel_state(channel) == SUCCESS) {
         /* Get packet from queue */
         this_packet = fifoqueue_get(buffer);
+        this_packet->success_time = now;
 
         /* Transmission was a success. The channel is now IDLE. */
         set_channel_state(channel, IDLE);
 
         TRACE(printf("Success.\n"););
 
+#if !PROGRESS_THREAD
         /* Output activity blip every so often. */
         output_blip_to_screen(simulation_run);
+#endif
 
         /* Collect Statistics */
         double packet_delay = simulation_run_get_time(simulation_run) - this_packet->arrive_time;
@@ -183,7 +195,11 @@ transmission_end_event(Simulation_Run_Ptr simulation_run, void* packet)
             set_channel_state(channel, IDLE);
         }
 
-        backoff_duration = 2.0 * uniform_generator() * MEAN_BACKOFF_DURATION;
+        backoff_duration = 2.0 *
+            random_backoff_uniform(data, this_packet->station_id) *
+            data->mean_backoff_duration;
+        this_packet->backoff_excess +=
+            backoff_duration - data->mean_backoff_duration;
 
         schedule_transmission_start_event(simulation_run,
             now + backoff_duration,
@@ -204,6 +220,7 @@ start_processing_on_cloud_server(Simulation_Run_Ptr simulation_run,
 
         server_put(link, (void*)this_packet);
     this_packet->status = TRANSMITTING;
+    this_packet->cloud_start_time = simulation_run_get_time(simulation_run);
 
     /* Schedule the end of packet processing event. */
     schedule_end_packet_processing_event(simulation_run,
@@ -242,20 +259,77 @@ end_packet_processing_event(Simulation_Run_Ptr simulation_run, void* link)
     /* Packet transmission is finished. Take the packet off the data link. */
     this_packet = (Packet_Ptr)server_get(link);
 
+#if !PROGRESS_THREAD
     /* Output activity blip every so often. */
     output_blip_to_screen(simulation_run);
+#endif
 
     /* Collect statistics. */
     double packet_delay = simulation_run_get_time(simulation_run) - this_packet->arrive_time;
 
-    data->packets_processed++;
+    COUNTER_INCREMENT(data->packets_processed);
     data->accumulated_delay += packet_delay;
 
+#if SEQUENTIAL_STOPPING
+    /* Stop once the batch means are precise enough. */
+    if (batch_means_add(&data->delay_batches, packet_delay,
+                        simulation_run_get_time(simulation_run)) &&
+        batch_means_converged(&data->delay_batches, RELATIVE_PRECISION) &&
+        (!WARMUP_DETECTION || data->warmup.done)) {
+        data->stop_run = 1;
+    }
+#endif
+
+#if CONTROL_VARIATES
+    {
+      double controls[CONTROLS];
+
+      controls[INTERARRIVAL_CONTROL] = this_packet->interarrival_time;
+      controls[UPLOAD_CONTROL] = this_packet->upload_time;
+      controls[SERVICE_CONTROL] = this_packet->service_time;
+      controls[BACKOFF_CONTROL] = this_packet->backoff_excess;
+      control_variates_add(&data->control_variates, packet_delay, controls);
+    }
+#endif
+
+#if REGENERATIVE
+    regenerative_add(&data->regeneration, packet_delay);
+#endif
+
+#if RESTART_SPLITTING
+    if (packet_delay > TAIL_DELAY_THRESHOLD) data->tail_packets++;
+#endif
+
     (data->stations + this_packet->station_id)->packets_processed++;
     (data->stations + this_packet->station_id)->accumulated_delay += packet_delay;
 
+    delay_stats_add(&data->delay_stats, packet_delay);
+    delay_stats_add(&(data->stations + this_packet->station_id)->delay_stats, packet_delay);
+
+#if WARMUP_DETECTION
+    /*
+     * Discard everything collected during the initial transient. This comes
+     * after all of the packet's statistics, so that it is discarded with them.
+     */
+    if (!data->warmup.done &&
+        warmup_detector_add(&data->warmup, packet_delay)) {
+        statistics_truncate_warmup(simulation_run);
+    }
+#endif
+
+    if (data->packet_export != NULL) {
+        packet_export_add(data->packet_export, (void*)this_packet,
+            simulation_run_get_time(simulation_run));
+    }
+
+    if (data->metrics != NULL &&
+        data->packets_processed % METRICS_UPDATE_INTERVAL == 0) {
+        metrics_publish(data->metrics, simulation_run);
+    }
+
     /* This packet is done ... give the memory back. */
-    free((void*)this_packet);
+    data->packets_in_system--;
+    xfree((void*)this_packet);
 
     /*
      * See if there is are packets waiting in the buffer. If so, take the next one
@@ -0,0 +1,194 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "simlib.h"
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/*******************************************************************************/
+
+static const char * counter_names[PERF_COUNTERS] = {
+  "cycles", "instructions", "LLC misses", "branch misses"
+};
+
+#ifdef __linux__
+
+static const uint64_t counter_configs[PERF_COUNTERS] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static int
+perf_event_open(struct perf_event_attr * attr)
+{
+  return (int) syscall(__NR_perf_event_open, attr, 0, -1, -1, 0);
+}
+
+#endif /* __linux__ */
+
+/*
+ * Open the counters, disabled. Returns NULL if none of them can be opened.
+ */
+
+Perf_Counters_Ptr
+perf_counters_open(void)
+{
+  Perf_Counters_Ptr counters;
+  int i, opened = 0;
+
+  counters = (Perf_Counters_Ptr) xcalloc(1, sizeof(Perf_Counters));
+
+  for (i=0; i<PERF_COUNTERS; i++) {
+    counters->fd[i] = -1;
+
+#ifdef __linux__
+    {
+      struct perf_event_attr attr;
+
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = counter_configs[i];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+	PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      if ((counters->fd[i] = perf_event_open(&attr)) >= 0) opened++;
+    }
+#endif
+  }
+
+  if (opened == 0) {
+    printf("Warning: No hardware performance counters are available\n");
+    xfree(counters);
+    return NULL;
+  }
+  return counters;
+}
+
+/*
+ * Reset and enable the counters. The events executed are counted from here.
+ */
+
+void
+perf_counters_start(Perf_Counters_Ptr counters,
+		    Simulation_Run_Ptr simulation_run)
+{
+  int i;
+
+  for (i=0; i<PERF_COUNTERS; i++) {
+    if (counters->fd[i] < 0) continue;
+#ifdef __linux__
+    ioctl(counters->fd[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(counters->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+  counters->events_start = simulation_run->events_executed;
+}
+
+/*
+ * Disable the counters and read them. Counts are scaled up if the kernel had
+ * to multiplex the counters.
+ */
+
+void
+perf_counters_stop(Perf_Counters_Ptr counters,
+		   Simulation_Run_Ptr simulation_run)
+{
+  int i;
+
+  counters->events = simulation_run->events_executed - counters->events_start;
+
+  for (i=0; i<PERF_COUNTERS; i++) {
+    counters->value[i] = 0;
+    if (counters->fd[i] < 0) continue;
+#ifdef __linux__
+    {
+      uint64_t reading[3];
+
+      ioctl(counters->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read(counters->fd[i], reading, sizeof(reading)) ==
+	  (ssize_t) sizeof(reading) && reading[2] > 0) {
+	counters->value[i] = (uint64_t)
+	  ((double) reading[0] * reading[1] / reading[2]);
+      }
+    }
+#endif
+  }
+}
+
+/*
+ * Print the counts of the last start/stop interval, in total, per event and
+ * per processed packet.
+ */
+
+void
+perf_counters_print(Perf_Counters_Ptr counters, long int packets)
+{
+  int i;
+
+  printf("Hardware counters (%ld events, %ld packets):\n", counters->events,
+	 packets);
+
+  for (i=0; i<PERF_COUNTERS; i++) {
+    if (counters->fd[i] < 0) {
+      printf("  %-14s not available\n", counter_names[i]);
+      continue;
+    }
+    printf("  %-14s %15llu %10.2f per event %10.2f per packet\n",
+	   counter_names[i], (unsigned long long) counters->value[i],
+	   counters->events > 0 ?
+	   (double) counters->value[i]/counters->events : 0.0,
+	   packets > 0 ? (double) counters->value[i]/packets : 0.0);
+  }
+
+  if (counters->fd[0] >= 0 && counters->fd[1] >= 0 && counters->value[0] > 0)
+    printf("  instructions per cycle %.2f\n",
+	   (double) counters->value[1]/counters->value[0]);
+}
+
+void
+perf_counters_close(Perf_Counters_Ptr counters)
+{
+  int i;
+
+  for (i=0; i<PERF_COUNTERS; i++) {
+#ifdef __linux__
+    if (counters->fd[i] >= 0) close(counters->fd[i]);
+#endif
+  }
+  xfree(counters);
+}
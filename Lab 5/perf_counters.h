@@ -0,0 +1,78 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+/*******************************************************************************/
+
+#include <stdint.h>
+
+/*******************************************************************************/
+
+/*
+ * Hardware performance counters (Linux perf_event) for the main event loop.
+ * Cycles, instructions, last level cache misses and branch misses are
+ * counted for this process in user mode only, so no special privileges are
+ * needed with the default perf_event_paranoid setting. Counters that can't be
+ * opened, e.g., in a virtual machine without a PMU, are left out. Elsewhere
+ * the counters are never available.
+ */
+
+#define PERF_COUNTERS 4
+
+typedef struct _perf_counters_
+{
+  int fd[PERF_COUNTERS];
+  uint64_t value[PERF_COUNTERS];
+  long int events_start;
+  long int events;
+} Perf_Counters, * Perf_Counters_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+struct _simulation_run_;
+
+Perf_Counters_Ptr
+perf_counters_open(void);
+
+void
+perf_counters_start(Perf_Counters_Ptr, struct _simulation_run_ *);
+
+void
+perf_counters_stop(Perf_Counters_Ptr, struct _simulation_run_ *);
+
+void
+perf_counters_print(Perf_Counters_Ptr, long int);
+
+void
+perf_counters_close(Perf_Counters_Ptr);
+
+/*******************************************************************************/
+
+#endif /* perf_counters.h */
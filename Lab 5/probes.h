@@ -0,0 +1,73 @@
+
+/*
+ * 
+ * Simlib Simulation Library
+ * 
+ * Copyright (C) 2014 Terence D. Todd
+ * Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/**********************************************************************/
+
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+/**********************************************************************/
+
+/*
+ * Static tracepoints (USDT) at the event list, FIFO queue, server and
+ * channel operations. Where <sys/sdt.h> is available (e.g., from
+ * systemtap-sdt-dev on Linux), each probe is a single NOP plus an ELF
+ * note describing where its arguments are, so it costs nothing until a
+ * tool attaches to it, e.g.,
+ *
+ *   bpftrace -e 'usdt:./aloha:simlib:event__execute__start { ... }'
+ *   perf probe -x ./aloha sdt_simlib:event__execute__start
+ *
+ * Elsewhere, or if NO_PROBES is defined, the probes compile to nothing.
+ *
+ * simlib:event__schedule          description, event time, event id
+ * simlib:event__execute__start    description, time, event id
+ * simlib:event__execute__done     description, event id
+ * simlib:event__deschedule        description, event id
+ * simlib:fifoqueue__put           queue, size after
+ * simlib:fifoqueue__get           queue, size after
+ * simlib:server__put              server, customer
+ * simlib:server__get              server, customer
+ * aloha:channel__state            channel, old state, new state
+ */
+
+#if !defined(NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROBES_ON
+#endif
+#endif
+
+#ifdef PROBES_ON
+#define PROBE2(provider, name, a, b) DTRACE_PROBE2(provider, name, a, b)
+#define PROBE3(provider, name, a, b, c) DTRACE_PROBE3(provider, name, a, b, c)
+#else
+#define PROBE2(provider, name, a, b)
+#define PROBE3(provider, name, a, b, c)
+#endif
+
+/**********************************************************************/
+
+#endif /* probes.h */
@@ -0,0 +1,205 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* for SCHED_IDLE */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simparameters.h"
+#include "main.h"
+#include "progress.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#include <time.h>
+#endif
+
+/*******************************************************************************/
+
+#ifndef _WIN32
+
+static double
+wall_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+/*
+ * Print one progress line. The line is formatted first and written in one
+ * piece, so that lines from replications running at the same time are not
+ * mixed up. Those are printed one per line and tagged with their seed.
+ */
+
+static void
+progress_report(Progress_Ptr progress)
+{
+  Simulation_Run_Data_Ptr data;
+  char line[256], eta[32];
+  long int events, packets, arrivals;
+  double now, interval, event_rate = 0.0, packet_rate = 0.0;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(progress->simulation_run);
+
+  events = COUNTER_GET(progress->simulation_run->events_executed);
+  packets = COUNTER_GET(data->packets_processed);
+  arrivals = COUNTER_GET(data->arrival_count);
+  now = wall_time();
+
+  /* The packet count starts over when the statistics are reset. */
+  if (packets < progress->last_packets) progress->last_packets = 0;
+
+  if ((interval = now - progress->last_wall_time) > 0) {
+    event_rate = (events - progress->last_events)/interval;
+    packet_rate = (packets - progress->last_packets)/interval;
+  }
+
+  if (packets >= RUNLENGTH) sprintf(eta, "0s");
+  else if (packet_rate > 0)
+    sprintf(eta, "%.0fs", (RUNLENGTH - packets)/packet_rate);
+  else sprintf(eta, "?");
+
+  if (progress->concurrent)
+    snprintf(line, sizeof(line), "Seed %u: ", data->random_seed);
+  else line[0] = '\0';
+
+  snprintf(line + strlen(line), sizeof(line) - strlen(line),
+	   "%3.0f%% Successfully Xmtted Pkts  = %ld (Arrived Pkts = %ld) "
+	   "%.3g events/s %.3g pkts/s ETA %s %s",
+	   100 * (double) packets/RUNLENGTH, packets, arrivals,
+	   event_rate, packet_rate, eta, progress->concurrent ? "\n" : "\r");
+
+  fputs(line, stdout);
+  fflush(stdout);
+
+  progress->last_events = events;
+  progress->last_packets = packets;
+  progress->last_wall_time = now;
+}
+
+/*
+ * The reporter thread reports every PROGRESS_INTERVAL seconds until the
+ * reporter is stopped. It runs at idle priority where that is available, so
+ * it never competes with the simulation for a processor.
+ */
+
+static void *
+progress_reporter(void * ptr)
+{
+  Progress_Ptr progress = (Progress_Ptr) ptr;
+  struct timespec deadline;
+
+#ifdef SCHED_IDLE
+  {
+    struct sched_param parameter;
+
+    parameter.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &parameter);
+  }
+#endif
+
+  pthread_mutex_lock(&progress->lock);
+  clock_gettime(CLOCK_REALTIME, &deadline);
+
+  while (!progress->stopping) {
+    deadline.tv_sec += (time_t) PROGRESS_INTERVAL;
+    deadline.tv_nsec += (long) (1e9 * (PROGRESS_INTERVAL -
+				       (time_t) PROGRESS_INTERVAL));
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (!progress->stopping &&
+	   pthread_cond_timedwait(&progress->changed, &progress->lock,
+				  &deadline) == 0);
+
+    if (!progress->stopping) progress_report(progress);
+  }
+
+  pthread_mutex_unlock(&progress->lock);
+  return NULL;
+}
+
+#endif /* _WIN32 */
+
+/*
+ * Start reporting the progress of a simulation_run. If concurrent is
+ * non-zero, other replications are printing their progress at the same time.
+ */
+
+Progress_Ptr
+progress_start(Simulation_Run_Ptr simulation_run, int concurrent)
+{
+  Progress_Ptr progress;
+
+  progress = (Progress_Ptr) xmalloc(sizeof(Progress));
+  progress->simulation_run = simulation_run;
+  progress->concurrent = concurrent;
+  progress->last_events = COUNTER_GET(simulation_run->events_executed);
+  progress->last_packets = 0;
+  progress->last_wall_time = 0.0;
+
+#ifndef _WIN32
+  progress->last_wall_time = wall_time();
+  progress->stopping = 0;
+  pthread_mutex_init(&progress->lock, NULL);
+  pthread_cond_init(&progress->changed, NULL);
+  if (pthread_create(&progress->reporter, NULL, progress_reporter,
+		     (void *) progress) != 0) {
+    printf("Error: Cannot start the progress reporter thread\n");
+    exit(1);
+  }
+#endif
+
+  return progress;
+}
+
+/*
+ * Stop the reporter and print the final progress of the simulation_run.
+ */
+
+void
+progress_stop(Progress_Ptr progress)
+{
+#ifndef _WIN32
+  pthread_mutex_lock(&progress->lock);
+  progress->stopping = 1;
+  pthread_cond_broadcast(&progress->changed);
+  pthread_mutex_unlock(&progress->lock);
+  pthread_join(progress->reporter, NULL);
+
+  progress_report(progress);
+
+  pthread_mutex_destroy(&progress->lock);
+  pthread_cond_destroy(&progress->changed);
+#endif
+
+  xfree(progress);
+}
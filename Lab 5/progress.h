@@ -0,0 +1,81 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _PROGRESS_H_
+#define _PROGRESS_H_
+
+/*******************************************************************************/
+
+#include "simlib.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * Progress reporting. A reporter thread wakes every PROGRESS_INTERVAL
+ * seconds, reads the event and packet counters of the simulation_run, and
+ * prints the progress with event and packet rates and the time remaining.
+ * The simulation itself does no output until the run is finished. Without
+ * threads (_WIN32) the old output_blip_to_screen is used instead.
+ */
+
+#ifndef _WIN32
+#define PROGRESS_THREAD 1
+#else
+#define PROGRESS_THREAD 0
+#endif
+
+typedef struct _progress_
+{
+  Simulation_Run_Ptr simulation_run;
+  int concurrent;
+  long int last_events;
+  long int last_packets;
+  double last_wall_time;
+#ifndef _WIN32
+  int stopping;
+  pthread_t reporter;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+#endif
+} Progress, * Progress_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Progress_Ptr
+progress_start(Simulation_Run_Ptr, int);
+
+void
+progress_stop(Progress_Ptr);
+
+/*******************************************************************************/
+
+#endif /* progress.h */
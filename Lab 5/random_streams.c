@@ -0,0 +1,114 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include "simparameters.h"
+#include "main.h"
+#include "random_streams.h"
+
+/*******************************************************************************/
+
+/*
+ * Each stream's seed is the run's seed offset by a multiple of the golden
+ * ratio constant, one for each purpose. rand_stream_initialize scrambles
+ * it, so the streams are far apart.
+ */
+
+#define STREAM_SEED(seed, purpose) ((seed) + 0x9E3779B9u * ((purpose) + 1u))
+
+enum {ARRIVAL_STREAM, STATION_STREAM, BACKOFF_STREAM};
+
+/*
+ * Seed the streams of a run, and set whether it is the antithetic one. The
+ * rand() sequence must have been seeded already, and the arrival source
+ * created.
+ */
+
+void
+random_streams_initialize(Simulation_Run_Ptr simulation_run, unsigned seed,
+			  int antithetic)
+{
+  Simulation_Run_Data_Ptr data;
+#if RANDOM_STREAMS
+  Station_Ptr station;
+  int i;
+#endif
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  data->antithetic = antithetic;
+  random_generator_set_antithetic(antithetic);
+
+#if RANDOM_STREAMS
+  rand_stream_initialize(&data->arrival_stream,
+			 STREAM_SEED(seed, ARRIVAL_STREAM));
+  data->arrival_stream.antithetic = antithetic;
+  rand_stream_initialize(&data->station_stream,
+			 STREAM_SEED(seed, STATION_STREAM));
+  data->station_stream.antithetic = antithetic;
+
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    station = data->stations + i;
+    rand_stream_initialize(&station->backoff_stream,
+			   STREAM_SEED(seed, BACKOFF_STREAM + (unsigned) i));
+    station->backoff_stream.antithetic = antithetic;
+  }
+
+  event_source_set_stream(data->arrival_source,
+			  rand_stream_exponential_generator,
+			  &data->arrival_stream);
+#else
+  (void) seed;
+#endif
+}
+
+/*
+ * The uniform that picks the station of an arrival.
+ */
+
+double
+random_station_uniform(Simulation_Run_Data_Ptr data)
+{
+#if RANDOM_STREAMS
+  return rand_stream_uniform_generator(&data->station_stream);
+#else
+  (void) data;
+  return uniform_generator();
+#endif
+}
+
+/*
+ * The uniform for the next backoff of a station.
+ */
+
+double
+random_backoff_uniform(Simulation_Run_Data_Ptr data, int station_id)
+{
+#if RANDOM_STREAMS
+  return rand_stream_uniform_generator(&(data->stations +
+					 station_id)->backoff_stream);
+#else
+  (void) data; (void) station_id;
+  return uniform_generator();
+#endif
+}
+
@@ -0,0 +1,71 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _RANDOM_STREAMS_H_
+#define _RANDOM_STREAMS_H_
+
+/*******************************************************************************/
+
+#include "main.h"
+
+/*******************************************************************************/
+
+/*
+ * Common random numbers. With COMMON_RANDOM_NUMBERS, each use of random
+ * numbers has a Rand_Stream of its own, seeded from the run's seed: the
+ * interarrival times, the station each packet arrives at, and the backoffs
+ * of each station. Two runs with the same seed but different parameters
+ * then see the same arrivals, and each station draws the same sequence of
+ * backoffs, so that the difference between their results is mostly the
+ * effect of the parameters rather than noise. Otherwise everything is drawn
+ * from the one rand() sequence, as before.
+ *
+ * An antithetic run draws 1-u wherever the normal run draws u, in either
+ * mode.
+ *
+ * Runs in parallel threads can't share the rand() sequence, so the
+ * regenerative workers always use streams.
+ */
+
+#define RANDOM_STREAMS (COMMON_RANDOM_NUMBERS || REGENERATIVE_CYCLES > 0)
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+random_streams_initialize(Simulation_Run_Ptr, unsigned, int);
+
+double
+random_station_uniform(Simulation_Run_Data_Ptr);
+
+double
+random_backoff_uniform(Simulation_Run_Data_Ptr, int);
+
+/*******************************************************************************/
+
+#endif /* random_streams.h */
+
@@ -0,0 +1,303 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "simparameters.h"
+#include "main.h"
+#include "output.h"
+#include "cleanup.h"
+#include "regenerative.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * One thread of the parallel mode, simulating cycle_limit cycles from the
+ * empty state with streams seeded from seed.
+ */
+
+typedef struct _regenerative_worker_
+{
+  unsigned seed;
+  long int cycle_limit;
+  Regenerative regeneration;
+  long int packets_processed;
+  long int events_executed;
+  long int peak_memory;
+} Regenerative_Worker, * Regenerative_Worker_Ptr;
+
+/*******************************************************************************/
+
+void
+regenerative_initialize(Regenerative_Ptr regeneration, long int cycle_limit)
+{
+  int i, j;
+
+  regeneration->cycle_limit = cycle_limit;
+  regeneration->cycles = 0;
+  for (i=0; i<CYCLE_MEASURES; i++) {
+    regeneration->mean[i] = 0.0;
+    for (j=0; j<CYCLE_MEASURES; j++) regeneration->comoment[i][j] = 0.0;
+  }
+  regeneration->in_cycle = 0;
+  regeneration->cycle_start = 0.0;
+  regeneration->cycle_delay = 0.0;
+  regeneration->cycle_packets = 0;
+}
+
+/*
+ * A packet arrives to an empty system at time now. This ends the cycle in
+ * progress, if there is one, and starts the next. Returns 1 when
+ * cycle_limit cycles have been completed, and 0 otherwise.
+ */
+
+int
+regenerative_epoch(Regenerative_Ptr regeneration, double now)
+{
+  double x[CYCLE_MEASURES], d[CYCLE_MEASURES];
+  int i, j;
+
+  if (regeneration->in_cycle) {
+    x[CYCLE_DELAY] = regeneration->cycle_delay;
+    x[CYCLE_PACKETS] = (double) regeneration->cycle_packets;
+    x[CYCLE_LENGTH] = now - regeneration->cycle_start;
+
+    /* Welford's update of the means and co-moments. */
+    regeneration->cycles++;
+    for (i=0; i<CYCLE_MEASURES; i++) {
+      d[i] = x[i] - regeneration->mean[i];
+      regeneration->mean[i] += d[i]/regeneration->cycles;
+    }
+    for (i=0; i<CYCLE_MEASURES; i++)
+      for (j=0; j<CYCLE_MEASURES; j++)
+	regeneration->comoment[i][j] += d[i]*(x[j] - regeneration->mean[j]);
+  }
+
+  regeneration->in_cycle = 1;
+  regeneration->cycle_start = now;
+  regeneration->cycle_delay = 0.0;
+  regeneration->cycle_packets = 0;
+
+  return regeneration->cycle_limit > 0 &&
+    regeneration->cycles >= regeneration->cycle_limit;
+}
+
+/*
+ * A packet has been processed with the given delay. Packets processed
+ * before the first epoch belong to no cycle and are left out.
+ */
+
+void
+regenerative_add(Regenerative_Ptr regeneration, double delay)
+{
+  if (!regeneration->in_cycle) return;
+  regeneration->cycle_delay += delay;
+  regeneration->cycle_packets++;
+}
+
+/*
+ * Add the completed cycles of part to total (Chan, Golub and LeVeque).
+ */
+
+void
+regenerative_merge(Regenerative_Ptr total, Regenerative_Ptr part)
+{
+  double delta[CYCLE_MEASURES], n;
+  int i, j;
+
+  if (part->cycles == 0) return;
+
+  n = (double) (total->cycles + part->cycles);
+  for (i=0; i<CYCLE_MEASURES; i++) delta[i] = part->mean[i] - total->mean[i];
+  for (i=0; i<CYCLE_MEASURES; i++)
+    for (j=0; j<CYCLE_MEASURES; j++)
+      total->comoment[i][j] += part->comoment[i][j] +
+	delta[i]*delta[j]*total->cycles*part->cycles/n;
+  for (i=0; i<CYCLE_MEASURES; i++) total->mean[i] += delta[i]*part->cycles/n;
+  total->cycles += part->cycles;
+}
+
+/*
+ * The ratio of the means of two cycle measures, y/x, with its 95%
+ * confidence interval. The variance of y - ratio*x over the cycles gives the
+ * variance of the ratio.
+ */
+
+static Confidence_Interval
+ratio_estimate(Regenerative_Ptr regeneration, Cycle_Measure y, Cycle_Measure x)
+{
+  Confidence_Interval ci;
+  double ratio, variance;
+  long int n = regeneration->cycles;
+
+  ci.mean = 0.0;
+  ci.half_width = HUGE_VAL;
+  if (n < 2 || regeneration->mean[x] == 0.0) return ci;
+
+  ratio = regeneration->mean[y]/regeneration->mean[x];
+  variance = (regeneration->comoment[y][y] -
+	      2.0*ratio*regeneration->comoment[y][x] +
+	      ratio*ratio*regeneration->comoment[x][x])/(n-1);
+  if (variance < 0.0) variance = 0.0;
+
+  ci.mean = ratio;
+  ci.half_width = student_t_quantile(n-1 < 1000000 ? (int) (n-1) : 1000000) *
+    sqrt(variance/n)/regeneration->mean[x];
+  return ci;
+}
+
+Confidence_Interval
+regenerative_delay(Regenerative_Ptr regeneration)
+{
+  return ratio_estimate(regeneration, CYCLE_DELAY, CYCLE_PACKETS);
+}
+
+Confidence_Interval
+regenerative_throughput(Regenerative_Ptr regeneration)
+{
+  return ratio_estimate(regeneration, CYCLE_PACKETS, CYCLE_LENGTH);
+}
+
+/*
+ * Simulate the worker's cycles in a simulation_run of its own. Nothing is
+ * shared with the other workers: the random numbers come from the run's
+ * streams, and the memory accounts are per thread.
+ */
+
+static void *
+regenerative_worker(void * worker_ptr)
+{
+  Regenerative_Worker_Ptr worker = (Regenerative_Worker_Ptr) worker_ptr;
+  Simulation_Run_Ptr simulation_run;
+  Simulation_Run_Data data;
+
+  /* Each worker reports its own peak, even when they share a thread. */
+  memory_usage_reset();
+
+  simulation_run = simulation_run_new();
+  simulation_run_set_data(simulation_run, (void *) &data);
+
+  data.packet_export = NULL;
+  data.metrics = NULL;
+  data.progress = NULL;
+  data.arrival_traces = NULL;
+  run_initialize(simulation_run, worker->seed, 0);
+  regenerative_initialize(&data.regeneration, worker->cycle_limit);
+
+  /* The run starts empty, so its first arrival is the first epoch. */
+  event_source_schedule_next(simulation_run, data.arrival_source);
+
+  while (!data.stop_run && simulation_run_events_pending(simulation_run) &&
+	 (EVENT_BUDGET == 0 || simulation_run->events_executed < EVENT_BUDGET)) {
+    simulation_run_execute_event(simulation_run);
+  }
+
+  worker->regeneration = data.regeneration;
+  worker->packets_processed = data.packets_processed;
+  worker->events_executed = simulation_run->events_executed;
+
+  cleanup(simulation_run);
+  worker->peak_memory = memory_usage(MEMORY_TOTAL).peak;
+  return NULL;
+}
+
+/*
+ * Simulate REGENERATIVE_CYCLES cycles, shared out over REGENERATIVE_THREADS
+ * threads (one per processor with 0), and report the estimates from all of
+ * them together. Worker k's streams are seeded from seed + k. The workers
+ * are merged in order, so the results depend only on the seed and the
+ * number of threads.
+ */
+
+void
+regenerative_run_parallel(unsigned seed)
+{
+  Regenerative_Worker_Ptr workers, worker;
+  Regenerative total;
+  long int packets = 0;
+  int threads = REGENERATIVE_THREADS;
+  int k;
+
+#ifndef _WIN32
+  pthread_t * thread_ids;
+
+  if (threads <= 0) threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (threads <= 0) threads = 1;
+  if (threads > REGENERATIVE_CYCLES) threads = REGENERATIVE_CYCLES;
+
+  workers = (Regenerative_Worker_Ptr)
+    xcalloc((unsigned) threads, sizeof(Regenerative_Worker));
+  for (k=0; k<threads; k++) {
+    workers[k].seed = seed + (unsigned) k;
+    workers[k].cycle_limit = REGENERATIVE_CYCLES/threads +
+      (k < REGENERATIVE_CYCLES % threads);
+  }
+
+  printf("\nSimulating %ld regenerative cycles in %d threads (seed %u) ...\n",
+	 (long int) REGENERATIVE_CYCLES, threads, seed);
+  fflush(stdout);
+
+#ifndef _WIN32
+  thread_ids = (pthread_t *) xcalloc((unsigned) threads, sizeof(pthread_t));
+  for (k=0; k<threads; k++) {
+    if (pthread_create(&thread_ids[k], NULL, regenerative_worker,
+		       (void *) &workers[k]) != 0) {
+      printf("***** ERROR: Cannot start worker thread %d *****\n", k);
+      exit(1);
+    }
+  }
+  for (k=0; k<threads; k++) pthread_join(thread_ids[k], NULL);
+  xfree(thread_ids);
+#else
+  /* There are no threads here, so the workers run one after the other. */
+  for (k=0; k<threads; k++) regenerative_worker((void *) &workers[k]);
+#endif
+
+  regenerative_initialize(&total, REGENERATIVE_CYCLES);
+  for (k=0; k<threads; k++) {
+    worker = workers + k;
+    printf("Worker %2d: %ld cycles, %ld packets, %ld events", k,
+	   worker->regeneration.cycles, worker->packets_processed,
+	   worker->events_executed);
+#if MEMORY_REPORT
+    printf(", peak heap %ld bytes", worker->peak_memory);
+#endif
+    printf("%s\n", worker->regeneration.cycles < worker->cycle_limit ?
+	   " (stopped early)" : "");
+    regenerative_merge(&total, &worker->regeneration);
+    packets += worker->packets_processed;
+  }
+  xfree(workers);
+
+  printf("Xmtted Pkts  = %ld\n", packets);
+  output_regenerative(&total);
+}
+
@@ -0,0 +1,102 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _REGENERATIVE_H_
+#define _REGENERATIVE_H_
+
+/*******************************************************************************/
+
+#include "simparameters.h"
+#include "batch_means.h"
+
+/*******************************************************************************/
+
+/*
+ * Regenerative estimation. The system starts afresh whenever a packet
+ * arrives to find every station buffer empty, the channel IDLE and the
+ * cloud server FREE: interarrival times are exponential, so nothing about
+ * the past is left to affect the future. The time between two such
+ * arrivals is a cycle, and the cycles are independent and identically
+ * distributed. For each one the total delay of the packets that arrived in
+ * it (all of which are processed before it ends), their number and the
+ * cycle's length are kept, and the mean delay and throughput are ratios of
+ * their means, with confidence intervals from the central limit theorem for
+ * ratio estimators. No initial transient has to be discarded.
+ *
+ * Only the means and co-moments of the cycle measures are kept, and
+ * estimators from independent runs can be merged.
+ */
+
+#define REGENERATIVE (REGENERATIVE_ESTIMATION || REGENERATIVE_CYCLES > 0)
+
+typedef enum {
+  CYCLE_DELAY,
+  CYCLE_PACKETS,
+  CYCLE_LENGTH,
+  CYCLE_MEASURES
+} Cycle_Measure;
+
+typedef struct _regenerative_
+{
+  long int cycle_limit;
+  long int cycles;
+  double mean[CYCLE_MEASURES];
+  double comoment[CYCLE_MEASURES][CYCLE_MEASURES];
+  int in_cycle;
+  double cycle_start;
+  double cycle_delay;
+  long int cycle_packets;
+} Regenerative, * Regenerative_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+regenerative_initialize(Regenerative_Ptr, long int);
+
+int
+regenerative_epoch(Regenerative_Ptr, double);
+
+void
+regenerative_add(Regenerative_Ptr, double);
+
+void
+regenerative_merge(Regenerative_Ptr, Regenerative_Ptr);
+
+Confidence_Interval
+regenerative_delay(Regenerative_Ptr);
+
+Confidence_Interval
+regenerative_throughput(Regenerative_Ptr);
+
+void
+regenerative_run_parallel(unsigned);
+
+/*******************************************************************************/
+
+#endif /* regenerative.h */
+
@@ -0,0 +1,306 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simparameters.h"
+#include "main.h"
+#include "branch.h"
+#include "restart.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#endif
+
+/*******************************************************************************/
+
+/*
+ * Each retrial gets a seed of its own from the main trial's. The constant is
+ * not the one that spreads the streams of a run (see random_streams.c), so
+ * the streams of different retrials don't coincide.
+ */
+
+#define CLONE_SEED(seed, clone) ((seed) + 0x85EBCA6Bu * (clone))
+
+static void
+restart_trial(Restart_Ptr, Simulation_Run_Ptr, int, int);
+
+/*******************************************************************************/
+
+/*
+ * Create the Restart for a run, from RESTART_THRESHOLDS and RESTART_SPLITS.
+ * It is shared with the forked trials.
+ */
+
+Restart_Ptr
+restart_new(void)
+{
+  Restart_Ptr restart;
+  double thresholds[] = {RESTART_THRESHOLDS};
+  int splits[] = {RESTART_SPLITS};
+  int levels = (int) (sizeof(thresholds)/sizeof(double));
+  int i;
+
+  if (levels > RESTART_MAX_LEVELS ||
+      (int) (sizeof(splits)/sizeof(int)) != levels) {
+    printf("Error: RESTART_THRESHOLDS and RESTART_SPLITS must list the same "
+	   "number of levels, at most %d.\n", RESTART_MAX_LEVELS);
+    exit(1);
+  }
+
+#ifndef _WIN32
+  restart = (Restart_Ptr) mmap(NULL, sizeof(Restart), PROT_READ | PROT_WRITE,
+			       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (restart == (Restart_Ptr) MAP_FAILED) {
+    perror("mmap");
+    exit(1);
+  }
+  memset(restart, 0, sizeof(Restart));
+#else
+  restart = (Restart_Ptr) xcalloc(1, sizeof(Restart));
+  printf("RESTART splitting needs fork(). The main trial runs alone.\n");
+#endif
+
+  restart->levels = levels;
+  restart->splits[0] = 1;
+  restart->weight[0] = 1.0;
+  for (i=1; i<=levels; i++) {
+    restart->threshold[i] = thresholds[i-1];
+    restart->splits[i] = splits[i-1];
+    if (restart->splits[i] < 1 ||
+	(i > 1 && restart->threshold[i] <= restart->threshold[i-1])) {
+      printf("Error: RESTART_THRESHOLDS must increase, and RESTART_SPLITS "
+	     "be at least 1.\n");
+      exit(1);
+    }
+#ifdef _WIN32
+    restart->splits[i] = 1;
+#endif
+    restart->weight[i] = restart->weight[i-1]/restart->splits[i];
+  }
+  return restart;
+}
+
+void
+restart_free(Restart_Ptr restart)
+{
+#ifndef _WIN32
+  munmap((void *) restart, sizeof(Restart));
+#else
+  xfree(restart);
+#endif
+}
+
+/*******************************************************************************/
+
+/*
+ * The importance of the current state: the number of packets in the
+ * system, or the age of the oldest one.
+ */
+
+static double
+importance(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+#if RESTART_IMPORTANCE == 1
+  Packet_Ptr packet;
+  double now, oldest;
+  int i;
+#endif
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+#if RESTART_IMPORTANCE == 0
+  return (double) data->packets_in_system;
+#else
+  now = oldest = simulation_run_get_time(simulation_run);
+
+  for (i=0; i<NUMBER_OF_STATIONS; i++) {
+    if (fifoqueue_size((data->stations+i)->buffer) > 0) {
+      packet = (Packet_Ptr) fifoqueue_see_front((data->stations+i)->buffer);
+      if (packet->arrive_time < oldest) oldest = packet->arrive_time;
+    }
+  }
+  if (server_state(data->cloud_server) == BUSY) {
+    packet = (Packet_Ptr) data->cloud_server->customer_in_service;
+    if (packet->arrive_time < oldest) oldest = packet->arrive_time;
+  }
+  if (fifoqueue_size(data->cloud_server_queue) > 0) {
+    packet = (Packet_Ptr) fifoqueue_see_front(data->cloud_server_queue);
+    if (packet->arrive_time < oldest) oldest = packet->arrive_time;
+  }
+  return now - oldest;
+#endif
+}
+
+static int
+importance_level(Restart_Ptr restart, Simulation_Run_Ptr simulation_run)
+{
+  double value = importance(simulation_run);
+  int level = 0;
+
+  while (level < restart->levels && value >= restart->threshold[level+1])
+    level++;
+  return level;
+}
+
+static int
+restart_batch(long int packets_processed)
+{
+  long int batch = packets_processed * RESTART_BATCHES / RUNLENGTH;
+
+  return batch < RESTART_BATCHES ? (int) batch : RESTART_BATCHES - 1;
+}
+
+/*
+ * Clone a retrial of the given level from the trial's current state, and
+ * wait for it to finish.
+ */
+
+static void
+restart_clone(Restart_Ptr restart, Simulation_Run_Ptr simulation_run,
+	      int level, int batch)
+{
+#ifndef _WIN32
+  pid_t pid;
+  int status;
+  unsigned seed;
+
+  seed = CLONE_SEED(restart->seed, ++restart->clones);
+  restart->retrials[level]++;
+
+  fflush(stdout);
+  if ((pid = fork()) < 0) {
+    perror("fork");
+    exit(1);
+  }
+
+  if (pid == 0) {
+    branch_detach(simulation_run, seed);
+    restart_trial(restart, simulation_run, level, batch);
+    _exit(0);
+  }
+
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    printf("Error: A RESTART retrial failed.\n");
+    exit(1);
+  }
+#else
+  (void) restart; (void) simulation_run; (void) level; (void) batch;
+#endif
+}
+
+/*
+ * Run a trial born at birth_level (0 for the main trial) until it falls
+ * below that level or the run is over. Each threshold crossed upwards
+ * splits it. Packets over the delay threshold count with the weight of the
+ * level the trial was in before the event that processed them.
+ */
+
+static void
+restart_trial(Restart_Ptr restart, Simulation_Run_Ptr simulation_run,
+	      int birth_level, int batch)
+{
+  Simulation_Run_Data_Ptr data;
+  long int tail_packets, packets_processed;
+  int level = birth_level, new_level, k;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  for (;;) {
+    new_level = importance_level(restart, simulation_run);
+    if (new_level < birth_level) break;
+
+    while (level < new_level) {
+      level++;
+      for (k=1; k<restart->splits[level]; k++)
+	restart_clone(restart, simulation_run, level, batch);
+    }
+    level = new_level;
+
+    if (!run_in_progress(simulation_run)) break;
+
+    tail_packets = data->tail_packets;
+    packets_processed = data->packets_processed;
+    simulation_run_execute_event(simulation_run);
+    restart->events++;
+
+    if (data->tail_packets != tail_packets)
+      restart->tail_weight[batch] += restart->weight[level];
+
+    /* Only the main trial moves on through the batches. */
+    if (birth_level == 0 && data->packets_processed != packets_processed) {
+      restart->main_packets[batch]++;
+      if (data->tail_packets != tail_packets) restart->main_tail_packets++;
+      batch = restart_batch(data->packets_processed);
+    }
+  }
+}
+
+/*
+ * Run the main trial, and all of its retrials, to the end of the run.
+ */
+
+void
+restart_run(Restart_Ptr restart, Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  restart->seed = data->random_seed;
+  restart_trial(restart, simulation_run, 0,
+		restart_batch(data->packets_processed));
+}
+
+/*
+ * P(delay > TAIL_DELAY_THRESHOLD) over all of the trials, with the
+ * confidence interval from its batches.
+ */
+
+Confidence_Interval
+restart_tail_probability(Restart_Ptr restart)
+{
+  Confidence_Interval ci;
+  double batch_probability[RESTART_BATCHES], tail_weight = 0.0;
+  long int packets = 0;
+  int b, n = 0;
+
+  for (b=0; b<RESTART_BATCHES; b++) {
+    if (restart->main_packets[b] == 0) continue;
+    batch_probability[n++] = restart->tail_weight[b]/restart->main_packets[b];
+    tail_weight += restart->tail_weight[b];
+    packets += restart->main_packets[b];
+  }
+
+  ci = confidence_interval(batch_probability, n);
+  ci.mean = packets > 0 ? tail_weight/packets : 0.0;
+  return ci;
+}
+
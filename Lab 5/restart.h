@@ -0,0 +1,92 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _RESTART_H_
+#define _RESTART_H_
+
+/*******************************************************************************/
+
+#include "main.h"
+
+/*******************************************************************************/
+
+/*
+ * RESTART splitting for the delay tail, P(delay > TAIL_DELAY_THRESHOLD).
+ * The state is given an importance, the backlog or the age of the oldest
+ * packet in the system (RESTART_IMPORTANCE), and RESTART_THRESHOLDS divide
+ * it into levels. Whenever a trial crosses threshold i upwards, it is split:
+ * R_i-1 retrials (RESTART_SPLITS) are cloned from its state and continued
+ * with fresh random numbers, each until it falls back below threshold i.
+ * The main trial is never cut short. So in level i there are, on average,
+ * R_1...R_i times as many trials as in the main trial alone, and a packet
+ * whose delay exceeds the threshold counts with weight 1/(R_1...R_i), where
+ * i is the level its trial was in.
+ *
+ * The trials are forked processes run one at a time, depth first, so their
+ * counts go straight into a Restart shared by all of them. The main trial
+ * is divided into RESTART_BATCHES batches of processed packets, and each
+ * retrial counts towards the batch it was split from, which gives the
+ * confidence interval.
+ */
+
+#define RESTART_MAX_LEVELS 16
+#define RESTART_BATCHES 20
+
+typedef struct _restart_
+{
+  unsigned seed;
+  int levels;
+  double threshold[RESTART_MAX_LEVELS+1];
+  int splits[RESTART_MAX_LEVELS+1];
+  double weight[RESTART_MAX_LEVELS+1];
+  unsigned clones;
+  long int retrials[RESTART_MAX_LEVELS+1];
+  long int events;
+  long int main_packets[RESTART_BATCHES];
+  long int main_tail_packets;
+  double tail_weight[RESTART_BATCHES];
+} Restart, * Restart_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Restart_Ptr
+restart_new(void);
+
+void
+restart_run(Restart_Ptr, Simulation_Run_Ptr);
+
+Confidence_Interval
+restart_tail_probability(Restart_Ptr);
+
+void
+restart_free(Restart_Ptr);
+
+/*******************************************************************************/
+
+#endif /* restart.h */
+
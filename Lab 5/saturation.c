@@ -0,0 +1,68 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include "simparameters.h"
+#include "saturation.h"
+
+/*******************************************************************************/
+
+void
+saturation_detector_initialize(Saturation_Detector_Ptr detector,
+			       long int backlog)
+{
+  detector->arrivals = 0;
+  detector->start_backlog = backlog;
+  detector->rising_windows = 0;
+  detector->drift = 0.0;
+  detector->saturated = 0;
+  detector->saturation_time = 0.0;
+}
+
+/*
+ * Add the backlog seen by an arrival at time now. Returns 1 when saturation
+ * has just been detected, and 0 otherwise.
+ */
+
+int
+saturation_detector_add(Saturation_Detector_Ptr detector, long int backlog,
+			double now)
+{
+  if (detector->saturated || ++detector->arrivals < SATURATION_WINDOW)
+    return 0;
+
+  detector->drift =
+    (double) (backlog - detector->start_backlog)/detector->arrivals;
+  detector->arrivals = 0;
+  detector->start_backlog = backlog;
+
+  if (detector->drift > SATURATION_THRESHOLD) detector->rising_windows++;
+  else detector->rising_windows = 0;
+
+  if (detector->rising_windows < SATURATION_WINDOWS) return 0;
+
+  detector->saturated = 1;
+  detector->saturation_time = now;
+  return 1;
+}
+
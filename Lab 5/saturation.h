@@ -0,0 +1,65 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _SATURATION_H_
+#define _SATURATION_H_
+
+/*******************************************************************************/
+
+/*
+ * Saturation detection. When the offered load is more than the channel can
+ * carry, the number of packets in the system grows without bound and the
+ * run never settles. The backlog is sampled after every arrival. Over each
+ * window of SATURATION_WINDOW arrivals, its growth per arrival is the drift.
+ * A stable system has no drift in the long run, so the run is declared
+ * saturated once SATURATION_WINDOWS consecutive windows have a drift above
+ * SATURATION_THRESHOLD.
+ */
+
+typedef struct _saturation_detector_
+{
+  long int arrivals;
+  long int start_backlog;
+  int rising_windows;
+  double drift;
+  int saturated;
+  double saturation_time;
+} Saturation_Detector, * Saturation_Detector_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+saturation_detector_initialize(Saturation_Detector_Ptr, long int);
+
+int
+saturation_detector_add(Saturation_Detector_Ptr, long int, double);
+
+/*******************************************************************************/
+
+#endif /* saturation.h */
+
@@ -27,7 +27,12 @@
 #include <math.h>
 
 #include "trace.h"
+#include "probes.h"
+#include "simparameters.h"
 #include "simlib.h"
+#include "event_trace.h"
+#include "event_profile.h"
+#include "fifoqueue_spill.h"
 
 /*******************************************************************************/
 
@@ -50,6 +55,9 @@ simulation_run_get_eventlist(Simulation_Run_Ptr);
 static Event_Container_Ptr
 simulation_run_get_event(Simulation_Run_Ptr);
 
+static Event_Source_Ptr
+simulation_run_get_source(Simulation_Run_Ptr);
+
 #ifdef TRACE_ON /* This is only used when tracing is active. */
 static void event_print_type(Event);
 #endif /* TRACE_ON */
@@ -70,6 +78,9 @@ simulation_run_new(void)
   new_simulation_run->eventlist = eventlist_new();
   new_simulation_run->clock = clock_new();
   new_simulation_run->data = NULL;
+  new_simulation_run->trace = NULL;
+  new_simulation_run->profile = NULL;
+  new_simulation_run->events_executed = 0;
   return new_simulation_run;
 }
 
@@ -130,6 +141,30 @@ simulation_run_set_data (Simulation_Run_Ptr this_simulation_run, void * data)
 }
 
 
+/*
+ * Record all event list activity in a binary trace from now on. The trace is
+ * closed when the simulation_run is freed.
+ */
+
+void
+simulation_run_set_trace(Simulation_Run_Ptr this_simulation_run,
+			 Event_Trace_Ptr trace)
+{
+  this_simulation_run->trace = trace;
+}
+
+/*
+ * Profile the event list from now on. The profile is freed when the
+ * simulation_run is freed.
+ */
+
+void
+simulation_run_set_profile(Simulation_Run_Ptr this_simulation_run,
+			   Event_Profile_Ptr profile)
+{
+  this_simulation_run->profile = profile;
+}
+
 /*
  * This function makes an entry on the event list. It must be passed the
  * simulation_run, the type of event, and the time that the event is to occur. An
@@ -146,10 +181,12 @@ simulation_run_schedule_event(Simulation_Run_Ptr simulation_run,
 
   double current_time;
   Eventlist_Ptr event_list;
-  static long int event_id = 1;
+  long int event_id;
+  int scan_depth;
 
   current_time = simulation_run_get_time(simulation_run);
   event_list = simulation_run_get_eventlist(simulation_run);
+  event_id = event_list->next_event_id++;
 
   TRACE(printf("At %.3f : ", current_time);)
   TRACE(event_print_type(new_event);)
@@ -164,19 +201,33 @@ simulation_run_schedule_event(Simulation_Run_Ptr simulation_run,
     exit(1);
   }
 
-  new_container = (Event_Container_Ptr) xmalloc(sizeof(Event_Container));
+  /* Keep the high-water mark of the list size. */
+  if (event_list->size >= event_list->max_size)
+    event_list->max_size = event_list->size + 1;
+
+  new_container = (Event_Container_Ptr)
+    xmalloc_tagged(sizeof(Event_Container), MEMORY_EVENTS);
   new_container->occurrence_time = new_event_time;
   new_container->event = new_event;
   new_container->next_container = NULL;
   new_container->previous_container = NULL;
   new_container->event_id = event_id;
 
+  if (simulation_run->trace != NULL)
+    event_trace_record(simulation_run->trace, simulation_run, TRACE_SCHEDULE,
+		       current_time, &new_event, new_event_time, event_id);
+
+  PROBE3(simlib, event__schedule, new_event.description, new_event_time,
+	 event_id);
+
   if (event_list->size == 0) {
     /* The list is empty. */
     event_list->front_ptr = new_container;
     event_list->back_ptr = new_container;
     event_list->size++;
-    return event_id++;
+    if (simulation_run->profile != NULL)
+      event_profile_schedule(simulation_run->profile, &new_event, 0);
+    return event_id;
   }
 
   if (event_list->front_ptr->occurrence_time > new_event_time) {
@@ -186,7 +237,9 @@ simulation_run_schedule_event(Simulation_Run_Ptr simulation_run,
     event_list->front_ptr = new_container;
 
     event_list->size++;
-    return event_id++;
+    if (simulation_run->profile != NULL)
+      event_profile_schedule(simulation_run->profile, &new_event, 0);
+    return event_id;
   }
 
   if (event_list->back_ptr->occurrence_time <= new_event_time) {
@@ -196,16 +249,21 @@ simulation_run_schedule_event(Simulation_Run_Ptr simulation_run,
     event_list->back_ptr = new_container;
 
     event_list->size++;
-    return event_id++;
+    if (simulation_run->profile != NULL)
+      event_profile_schedule(simulation_run->profile, &new_event,
+			     EVENT_PROFILE_BACK);
+    return event_id;
   }
 
   /* Add to the middle of the list. */
   current_container = event_list->front_ptr;
   next_container = event_list->front_ptr->next_container;
+  scan_depth = 1;
 
   while(next_container->occurrence_time <= new_event_time) {
     current_container = next_container;
     next_container = current_container->next_container;
+    scan_depth++;
   }
   current_container->next_container = new_container;
   new_container->previous_container = current_container;
@@ -213,7 +271,246 @@ simulation_run_schedule_event(Simulation_Run_Ptr simulation_run,
   new_container->next_container = next_container;
 
   event_list->size++;
-  return event_id++;
+  if (simulation_run->profile != NULL)
+    event_profile_schedule(simulation_run->profile, &new_event, scan_depth);
+  return event_id;
+}
+
+/*
+ * Get the number of events on the event list. A simulation_run that has
+ * nothing left to do has no events pending.
+ */
+
+int
+simulation_run_events_pending(Simulation_Run_Ptr simulation_run)
+{
+  Event_Source_Ptr source;
+  int pending;
+
+  pending = simulation_run->eventlist->size;
+  for (source = simulation_run->eventlist->sources; source != NULL;
+       source = source->next_source) pending += source->active;
+  return pending;
+}
+
+/*
+ * Add an event source to the simulation_run. The source is idle until it is
+ * scheduled. If interval_generator is not NULL, event_source_schedule_next
+ * schedules the source after the next interval generated by
+ * interval_generator(interval_parameter). Intervals are generated block_size
+ * at a time, or one at a time when block_size is 0 or 1.
+ */
+
+Event_Source_Ptr
+simulation_run_add_source(Simulation_Run_Ptr simulation_run, Event event,
+			  double (* interval_generator)(double),
+			  double interval_parameter, int block_size)
+{
+  Event_Source_Ptr new_source, * last;
+
+  new_source = (Event_Source_Ptr)
+    xmalloc_tagged(sizeof(Event_Source), MEMORY_EVENTS);
+  new_source->next_source = NULL;
+  new_source->event = event;
+  new_source->occurrence_time = 0.0;
+  new_source->event_id = 0;
+  new_source->active = 0;
+  new_source->interval_generator = interval_generator;
+  new_source->stream_generator = NULL;
+  new_source->stream = NULL;
+  new_source->interval_parameter = interval_parameter;
+  new_source->block_size = block_size > 1 ? block_size : 0;
+  new_source->next_interval = new_source->block_size;
+  new_source->intervals = NULL;
+  if (new_source->block_size > 0)
+    new_source->intervals =
+      (double *) xcalloc_tagged(new_source->block_size, sizeof(double),
+				MEMORY_EVENTS);
+
+  /* Sources are kept in the order they were added. */
+  last = &simulation_run->eventlist->sources;
+  while (*last != NULL) last = &(*last)->next_source;
+  *last = new_source;
+
+  return new_source;
+}
+
+/*
+ * Schedule the next event of an idle source. Like
+ * simulation_run_schedule_event, the event gets an event id, which is
+ * returned.
+ */
+
+long int
+event_source_schedule(Simulation_Run_Ptr simulation_run,
+		      Event_Source_Ptr source, double new_event_time)
+{
+  double current_time;
+
+  current_time = simulation_run_get_time(simulation_run);
+
+  TRACE(printf("At %.3f : ", current_time);)
+  TRACE(event_print_type(source->event);)
+  TRACE(printf("Scheduled for  %.3f \n", new_event_time);)
+
+  if (source->active) {
+    printf("Error: Event source \"%s\" is already scheduled\n",
+	   source->event.description);
+    exit(1);
+  }
+
+  if (new_event_time < current_time) {
+    printf("Error: Scheduling backwards in time: ");
+    printf("Event time = %f (Clock time = %f) \n", new_event_time, 
+    current_time);
+    printf("Event scheduled = \"%s\"\n", source->event.description);
+    exit(1);
+  }
+
+  source->occurrence_time = new_event_time;
+  source->event_id = simulation_run->eventlist->next_event_id++;
+  source->active = 1;
+
+  if (simulation_run->trace != NULL)
+    event_trace_record(simulation_run->trace, simulation_run, TRACE_SCHEDULE,
+		       current_time, &source->event, new_event_time,
+		       source->event_id);
+
+  if (simulation_run->profile != NULL)
+    event_profile_schedule(simulation_run->profile, &source->event,
+			   EVENT_PROFILE_SOURCE);
+
+  PROBE3(simlib, event__schedule, source->event.description, new_event_time,
+	 source->event_id);
+
+  return source->event_id;
+}
+
+/*
+ * Schedule the next event of an idle source one generated interval from
+ * now.
+ */
+
+long int
+event_source_schedule_next(Simulation_Run_Ptr simulation_run,
+			   Event_Source_Ptr source)
+{
+  return event_source_schedule(simulation_run, source,
+			       simulation_run_get_time(simulation_run) +
+			       event_source_next_interval(source));
+}
+
+/*
+ * Get the next interval of a source, refilling its block of pre-generated
+ * intervals when it is used up.
+ */
+
+static double
+event_source_generate(Event_Source_Ptr source)
+{
+  if (source->stream != NULL)
+    return (*source->stream_generator)(source->stream,
+				       source->interval_parameter);
+  return (*source->interval_generator)(source->interval_parameter);
+}
+
+double
+event_source_next_interval(Event_Source_Ptr source)
+{
+  int i;
+
+  if (source->block_size == 0) return event_source_generate(source);
+
+  if (source->next_interval == source->block_size) {
+    for (i=0; i<source->block_size; i++)
+      source->intervals[i] = event_source_generate(source);
+    source->next_interval = 0;
+  }
+  return source->intervals[source->next_interval++];
+}
+
+/*
+ * Draw the intervals of a source from its own random stream, e.g.,
+ * rand_stream_exponential_generator(stream, interval_parameter).
+ */
+
+void
+event_source_set_stream(Event_Source_Ptr source,
+			double (* stream_generator)(Rand_Stream_Ptr, double),
+			Rand_Stream_Ptr stream)
+{
+  source->stream_generator = stream_generator;
+  source->stream = stream;
+  event_source_flush(source);
+}
+
+/*
+ * Discard the pre-generated intervals of a source, e.g., after the random
+ * number generator has been reseeded.
+ */
+
+void
+event_source_flush(Event_Source_Ptr source)
+{
+  source->next_interval = source->block_size;
+}
+
+/*
+ * The following two functions are used when a simulation_run is restored from
+ * a checkpoint. The clock is set directly, and events are put back on the
+ * event list with the ids they had when the checkpoint was taken. Events must
+ * be restored in occurrence time order.
+ */
+
+void
+simulation_run_restore_time(Simulation_Run_Ptr simulation_run, double time)
+{
+  simulation_run_set_time(simulation_run, time);
+}
+
+void
+simulation_run_restore_event(Simulation_Run_Ptr simulation_run,
+			     Event event, double event_time, long int event_id)
+{
+  Eventlist_Ptr event_list;
+  Event_Container_Ptr new_container;
+
+  event_list = simulation_run_get_eventlist(simulation_run);
+
+  new_container = (Event_Container_Ptr)
+    xmalloc_tagged(sizeof(Event_Container), MEMORY_EVENTS);
+  new_container->occurrence_time = event_time;
+  new_container->event = event;
+  new_container->next_container = NULL;
+  new_container->previous_container = event_list->back_ptr;
+  new_container->event_id = event_id;
+
+  if (event_list->size == 0) event_list->front_ptr = new_container;
+  else event_list->back_ptr->next_container = new_container;
+  event_list->back_ptr = new_container;
+  event_list->size++;
+  if (event_list->size > event_list->max_size)
+    event_list->max_size = event_list->size;
+
+  if (event_id >= event_list->next_event_id)
+    event_list->next_event_id = event_id + 1;
+}
+
+void
+simulation_run_restore_source(Simulation_Run_Ptr simulation_run,
+			      Event_Source_Ptr source, double event_time,
+			      long int event_id)
+{
+  Eventlist_Ptr event_list;
+
+  event_list = simulation_run_get_eventlist(simulation_run);
+
+  source->occurrence_time = event_time;
+  source->event_id = event_id;
+  source->active = 1;
+
+  if (event_id >= event_list->next_event_id)
+    event_list->next_event_id = event_id + 1;
 }
 
 /*
@@ -269,7 +566,21 @@ simulation_run_deschedule_event(Simulation_Run_Ptr simulation_run,
       TRACE(event_print_type(found_container->event);)
       TRACE(printf("descheduled\n");)
 
-      free((void*) found_container);
+      if (simulation_run->trace != NULL)
+	event_trace_record(simulation_run->trace, simulation_run,
+			   TRACE_DESCHEDULE,
+			   simulation_run_get_time(simulation_run),
+			   &found_container->event,
+			   found_container->occurrence_time, event_id);
+
+      if (simulation_run->profile != NULL)
+	event_profile_deschedule(simulation_run->profile,
+				 &found_container->event, i);
+
+      PROBE2(simlib, event__deschedule, found_container->event.description,
+	     event_id);
+
+      xfree((void*) found_container);
       event_list->size--;
       break;
     }
@@ -314,15 +625,82 @@ simulation_run_get_event(Simulation_Run_Ptr simulation_run)
 }
 
 /*
- * Get the next event from the event list and pass program execution to its
- * event function.
+ * Find the active source whose event occurs first. If it occurs before the
+ * event at the front of the event list, make it idle and return it. Otherwise
+ * NULL is returned and the event list goes first.
+ */
+
+static Event_Source_Ptr
+simulation_run_get_source(Simulation_Run_Ptr simulation_run)
+{
+  Eventlist_Ptr event_list;
+  Event_Source_Ptr source, first_source = NULL;
+
+  event_list = simulation_run_get_eventlist(simulation_run);
+
+  for (source = event_list->sources; source != NULL;
+       source = source->next_source) {
+    if (source->active && (first_source == NULL ||
+			   source->occurrence_time <
+			   first_source->occurrence_time))
+      first_source = source;
+  }
+
+  if (first_source == NULL ||
+      (event_list->size > 0 &&
+       event_list->front_ptr->occurrence_time <=
+       first_source->occurrence_time)) return NULL;
+
+  first_source->active = 0;
+  return first_source;
+}
+
+/*
+ * Get the next event, either from an event source or from the event list,
+ * and pass program execution to its event function.
  */
 
 void
 simulation_run_execute_event(Simulation_Run_Ptr simulation_run)
 {
   Event_Container_Ptr current_container;
+  Event_Source_Ptr source;
+  uint64_t start;
+  int list_size;
+
+  COUNTER_INCREMENT(simulation_run->events_executed);
+
+  if ((source = simulation_run_get_source(simulation_run)) != NULL) {
+    simulation_run_set_time(simulation_run, source->occurrence_time);
+
+    TRACE(printf("\n");)
+    TRACE(event_print_type(source->event);)
+    TRACE(printf("occurring at %.3f\n", simulation_run_get_time(simulation_run));)
+
+    if (simulation_run->trace != NULL)
+      event_trace_record(simulation_run->trace, simulation_run, TRACE_EXECUTE,
+			 source->occurrence_time, &source->event,
+			 source->occurrence_time, source->event_id);
+
+    PROBE3(simlib, event__execute__start, source->event.description,
+	   source->occurrence_time, source->event_id);
+
+    if (simulation_run->profile != NULL) {
+      start = event_profile_cycles();
+      (*(source->event.function))(simulation_run, source->event.attachment);
+      event_profile_execute(simulation_run->profile, &source->event,
+			    simulation_run->eventlist->size,
+			    event_profile_cycles() - start);
+    } else {
+      (*(source->event.function))(simulation_run, source->event.attachment);
+    }
+
+    PROBE2(simlib, event__execute__done, source->event.description,
+	   source->event_id);
+    return;
+  }
 
+  list_size = simulation_run->eventlist->size;
   current_container = simulation_run_get_event(simulation_run);
   simulation_run_set_time(simulation_run, 
 			  current_container->occurrence_time);
@@ -331,8 +709,29 @@ simulation_run_execute_event(Simulation_Run_Ptr simulation_run)
   TRACE(event_print_type(current_container->event);)
   TRACE(printf("occurring at %.3f\n", simulation_run_get_time(simulation_run));)
 
-  (*(current_container->event.function))(simulation_run,
-			current_container->event.attachment);
+  if (simulation_run->trace != NULL)
+    event_trace_record(simulation_run->trace, simulation_run, TRACE_EXECUTE,
+		       current_container->occurrence_time,
+		       &current_container->event,
+		       current_container->occurrence_time,
+		       current_container->event_id);
+
+  PROBE3(simlib, event__execute__start, current_container->event.description,
+	 current_container->occurrence_time, current_container->event_id);
+
+  if (simulation_run->profile != NULL) {
+    start = event_profile_cycles();
+    (*(current_container->event.function))(simulation_run,
+			  current_container->event.attachment);
+    event_profile_execute(simulation_run->profile, &current_container->event,
+			  list_size, event_profile_cycles() - start);
+  } else {
+    (*(current_container->event.function))(simulation_run,
+			  current_container->event.attachment);
+  }
+
+  PROBE2(simlib, event__execute__done, current_container->event.description,
+	 current_container->event_id);
   xfree(current_container);
 }
 
@@ -344,6 +743,7 @@ void
 simulation_run_free_memory(Simulation_Run_Ptr this_simulation_run)
 {
   Eventlist_Ptr event_list;
+  Event_Source_Ptr source;
 
   /* Clean out the event list. */
   event_list = this_simulation_run->eventlist;
@@ -352,6 +752,18 @@ simulation_run_free_memory(Simulation_Run_Ptr this_simulation_run)
     xfree((void*) simulation_run_get_event(this_simulation_run));
   }
 
+  while ((source = event_list->sources) != NULL) {
+    event_list->sources = source->next_source;
+    if (source->intervals != NULL) xfree(source->intervals);
+    xfree(source);
+  }
+
+  if (this_simulation_run->trace != NULL)
+    event_trace_close(this_simulation_run->trace);
+
+  if (this_simulation_run->profile != NULL)
+    event_profile_free(this_simulation_run->profile);
+
   /* Clean up the simulation_run. */
   xfree(this_simulation_run->eventlist);
   xfree(this_simulation_run->clock);
@@ -375,6 +787,9 @@ eventlist_new(void)
   new_event_list->front_ptr = NULL;
   new_event_list->back_ptr = NULL;
   new_event_list->size = 0;
+  new_event_list->max_size = 0;
+  new_event_list->next_event_id = 1;
+  new_event_list->sources = NULL;
   return new_event_list;
 }
 
@@ -402,6 +817,68 @@ event_print_type(Event event)
 
 #endif /* TRACE_ON */
 
+/*
+ * Time-weighted average functions.
+ *
+ * Create a time average that starts now at the given level.
+ */
+
+Time_Average_Ptr
+time_average_new(Simulation_Run_Ptr simulation_run, double level)
+{
+  Time_Average_Ptr time_average;
+
+  time_average = (Time_Average_Ptr) xmalloc(sizeof(Time_Average));
+  time_average->clock = simulation_run->clock;
+  time_average->level = level;
+  time_average_reset(time_average);
+  return time_average;
+}
+
+/*
+ * Change the level. The area under the old level is added up to now.
+ */
+
+void
+time_average_set(Time_Average_Ptr time_average, double level)
+{
+  double now = time_average->clock->time;
+
+  time_average->area += time_average->level *
+    (now - time_average->last_change_time);
+  time_average->last_change_time = now;
+  time_average->level = level;
+}
+
+/*
+ * Get the time-average level from the start (or last reset) up to now.
+ */
+
+double
+time_average_get(Time_Average_Ptr time_average)
+{
+  double now = time_average->clock->time;
+  double area;
+
+  if (now <= time_average->start_time) return time_average->level;
+
+  area = time_average->area +
+    time_average->level * (now - time_average->last_change_time);
+  return area/(now - time_average->start_time);
+}
+
+/*
+ * Start averaging again from now, keeping the current level.
+ */
+
+void
+time_average_reset(Time_Average_Ptr time_average)
+{
+  time_average->area = 0.0;
+  time_average->start_time = time_average->clock->time;
+  time_average->last_change_time = time_average->start_time;
+}
+
 /*
  * FIFO queue functions
  *
@@ -414,13 +891,41 @@ fifoqueue_new(void)
 {
   Fifoqueue_Ptr queue_id;
 
-  queue_id = (Fifoqueue_Ptr) xmalloc(sizeof(Fifoqueue));
+  queue_id = (Fifoqueue_Ptr) xmalloc_tagged(sizeof(Fifoqueue), MEMORY_QUEUES);
   queue_id->size = 0;
   queue_id->front_ptr = NULL;
   queue_id->back_ptr  = NULL;
+  queue_id->occupancy = NULL;
+  queue_id->spill = NULL;
   return queue_id;
 }
 
+/*
+ * Track the time-average length of a FIFO queue from now on.
+ */
+
+void
+fifoqueue_track_occupancy(Fifoqueue_Ptr queue_ptr,
+			  Simulation_Run_Ptr simulation_run)
+{
+  queue_ptr->occupancy = time_average_new(simulation_run,
+					  (double) queue_ptr->size);
+}
+
+/*
+ * Free a FIFO queue. Anything still in it must be taken out first, since the
+ * queue doesn't know how to free its contents.
+ */
+
+void
+fifoqueue_free(Fifoqueue_Ptr queue_ptr)
+{
+  if (queue_ptr->spill != NULL) fifoqueue_spill_close(queue_ptr);
+  while (queue_ptr->size > 0) fifoqueue_get(queue_ptr);
+  if (queue_ptr->occupancy != NULL) xfree(queue_ptr->occupancy);
+  xfree(queue_ptr);
+}
+
 /*
  * Put something into a FIFO queue. Whatever it is should be cast to a void
  * pointer.
@@ -431,11 +936,15 @@ fifoqueue_put(Fifoqueue_Ptr queue_ptr, void * content_ptr)
 {
   Queue_Container_Ptr queue_container_ptr;
 
-  queue_container_ptr = (Queue_Container_Ptr) xmalloc(sizeof(Queue_Container));
+  queue_container_ptr = (Queue_Container_Ptr)
+    xmalloc_tagged(sizeof(Queue_Container), MEMORY_QUEUES);
   queue_container_ptr->content_ptr = content_ptr;
   queue_container_ptr->next_ptr = NULL;
 
-  if (queue_ptr->size == 0) {
+  if (queue_ptr->spill != NULL) {
+    fifoqueue_spill_put(queue_ptr, queue_container_ptr);
+  }
+  else if (queue_ptr->size == 0) {
     queue_ptr->front_ptr = queue_container_ptr;
     queue_ptr->back_ptr =  queue_container_ptr;
   }
@@ -444,6 +953,11 @@ fifoqueue_put(Fifoqueue_Ptr queue_ptr, void * content_ptr)
     queue_ptr->back_ptr = queue_container_ptr;
   }
   queue_ptr->size++;
+
+  if (queue_ptr->occupancy != NULL)
+    time_average_set(queue_ptr->occupancy, (double) queue_ptr->size);
+
+  PROBE2(simlib, fifoqueue__put, queue_ptr, queue_ptr->size);
 }
 
 /*
@@ -458,13 +972,22 @@ fifoqueue_get(Fifoqueue_Ptr queue_ptr)
   void* content_ptr;
 
   if (queue_ptr->size > 0) {
-    removed_container_ptr = queue_ptr->front_ptr;
-    queue_ptr->front_ptr = removed_container_ptr->next_ptr;
+    if (queue_ptr->spill != NULL) {
+      removed_container_ptr = fifoqueue_spill_get(queue_ptr);
+    }
+    else {
+      removed_container_ptr = queue_ptr->front_ptr;
+      queue_ptr->front_ptr = removed_container_ptr->next_ptr;
+      if(queue_ptr->size == 1) queue_ptr->back_ptr = NULL;
+    }
     content_ptr = removed_container_ptr->content_ptr;
-    free((char*) removed_container_ptr);
-
-    if(queue_ptr->size == 1) queue_ptr->back_ptr = NULL;
+    xfree((void*) removed_container_ptr);
     queue_ptr->size--;
+
+    if (queue_ptr->occupancy != NULL)
+      time_average_set(queue_ptr->occupancy, (double) queue_ptr->size);
+
+    PROBE2(simlib, fifoqueue__get, queue_ptr, queue_ptr->size);
   }
   else {
     content_ptr = NULL;
@@ -492,6 +1015,53 @@ fifoqueue_see_front(Fifoqueue_Ptr queue_ptr)
   return queue_ptr->front_ptr->content_ptr;
 }
 
+/*
+ * Keep the middle of the queue in a temporary file once it gets longer than
+ * two segments of segment_length (see fifoqueue_spill.h). Everything put in
+ * the queue must then be a block of record_size bytes from xmalloc_tagged
+ * with the given tag. If the file can't be made, the queue stays in memory.
+ */
+
+void
+fifoqueue_enable_spill(Fifoqueue_Ptr queue_ptr, unsigned record_size,
+		       int segment_length, Memory_Tag tag)
+{
+  Queue_Container_Ptr container;
+
+  if (queue_ptr->spill != NULL) return;
+  if ((queue_ptr->spill =
+       fifoqueue_spill_open(record_size, segment_length, tag)) == NULL) return;
+
+  /* Whatever is queued already becomes the head. */
+  for (container = queue_ptr->front_ptr; container != NULL;
+       container = container->next_ptr) {
+    queue_ptr->spill->head_back = container;
+    queue_ptr->spill->head_size++;
+  }
+}
+
+/*
+ * Call visit(content, argument) for each thing in the queue, front to back,
+ * until it returns non-zero. Returns the last value visit returned, or 0.
+ * What is visited must not be kept or changed, as it may be a spilled copy.
+ */
+
+int
+fifoqueue_visit(Fifoqueue_Ptr queue_ptr, int (* visit)(void *, void *),
+		void * argument)
+{
+  Queue_Container_Ptr container;
+  int result;
+
+  if (queue_ptr->spill != NULL)
+    return fifoqueue_spill_visit(queue_ptr, visit, argument);
+
+  for (container = queue_ptr->front_ptr; container != NULL;
+       container = container->next_ptr)
+    if ((result = visit(container->content_ptr, argument)) != 0) return result;
+  return 0;
+}
+
 /*
  * Server functions.
  *
@@ -503,12 +1073,35 @@ server_new(void)
 {
   Server_Ptr server_ptr;
 
-  server_ptr = (Server_Ptr) xmalloc(sizeof(Server));
+  server_ptr = (Server_Ptr) xmalloc_tagged(sizeof(Server), MEMORY_QUEUES);
   server_ptr->customer_in_service = NULL;
   server_ptr->state = FREE;
+  server_ptr->utilization = NULL;
   return server_ptr;
 }
 
+/*
+ * Track the fraction of time that a server is BUSY from now on.
+ */
+
+void
+server_track_utilization(Server_Ptr server, Simulation_Run_Ptr simulation_run)
+{
+  server->utilization = time_average_new(simulation_run,
+			   server->state == BUSY ? 1.0 : 0.0);
+}
+
+/*
+ * Free a server. Whatever is in service must be taken out first.
+ */
+
+void
+server_free(Server_Ptr server)
+{
+  if (server->utilization != NULL) xfree(server->utilization);
+  xfree(server);
+}
+
 /*
  * Pass a server pointer and an object pointer to place the object in the
  * server. The server is marked BUSY.
@@ -524,6 +1117,10 @@ server_put(Server_Ptr server, void* content_ptr)
 
   server->customer_in_service = content_ptr;
   server->state = BUSY;
+
+  if (server->utilization != NULL) time_average_set(server->utilization, 1.0);
+
+  PROBE2(simlib, server__put, server, content_ptr);
 }
 
 /*
@@ -545,6 +1142,10 @@ server_get(Server_Ptr server)
   entry = server->customer_in_service;
   server->customer_in_service = NULL;
   server->state = FREE;
+
+  if (server->utilization != NULL) time_average_set(server->utilization, 0.0);
+
+  PROBE2(simlib, server__get, server, entry);
   return entry;
 }
 
@@ -580,21 +1181,32 @@ rand_stream_new(unsigned seed)
 void
 rand_stream_initialize(Rand_Stream_Ptr rand_stream, unsigned seed)
 {
-  rand_stream->rand_max = 32767;
+  unsigned long long z;
+
+  rand_stream->rand_max = 2147483647;
   rand_stream->seed  = seed;
-  rand_stream->next = seed;
+  rand_stream->antithetic = 0;
+
+  /* Scramble the seed (SplitMix64), so that streams with nearby seeds start
+     far apart in the sequence. */
+  z = (unsigned long long) seed + 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  rand_stream->next = z ^ (z >> 31);
 }
 
 /*
- * Use our own code for rand so that we can make it thread-safe. This generator
- * is a pretty poor one but sufficient for our purposes.
+ * Use our own code for rand so that we can make it thread-safe. This is a
+ * 64-bit linear congruential generator (Knuth's MMIX constants), of which
+ * only the high bits, the good ones, are used.
  */
 
 unsigned
 rand_stream_get(Rand_Stream_Ptr rand_stream)
 {
-  rand_stream->next = rand_stream->next * 1103515245 + 12345;
-  return((unsigned)(rand_stream->next/65536) % rand_stream->rand_max);
+  rand_stream->next = rand_stream->next * 6364136223846793005ULL +
+    1442695040888963407ULL;
+  return((unsigned)(rand_stream->next >> 33) % rand_stream->rand_max);
 }
 
 double
@@ -606,6 +1218,8 @@ rand_stream_uniform_generator(Rand_Stream_Ptr rand_stream)
     r = (double) rand_stream_get(rand_stream)/(double)rand_stream->rand_max;
   } while (r == 1 || r == 0);
 
+  if (rand_stream->antithetic) r = 1.0 - r;
+
 if (r > 1.0) {
   printf ("***** ERROR: Random() out of bounds! ***** \n");
   exit(0);
@@ -621,10 +1235,50 @@ rand_stream_exponential_generator(Rand_Stream_Ptr rand_stream, double mean)
   return -1.0 * log(u) * mean;
 }
 
+/*
+ * The state of the rand() generator cannot be read back, so we keep the seed
+ * and the number of draws made since seeding. This is enough to put the
+ * generator back where it was, e.g., when restoring from a checkpoint.
+ */
+
+static unsigned random_generator_seed = 1;
+static unsigned long random_generator_draws = 0;
+static THREAD_LOCAL int random_generator_antithetic = 0;
+
 void
 random_generator_initialize(unsigned iseed)
 {
   srand(iseed);
+  random_generator_seed = iseed;
+  random_generator_draws = 0;
+}
+
+void
+random_generator_get_state(unsigned * iseed, unsigned long * draws)
+{
+  *iseed = random_generator_seed;
+  *draws = random_generator_draws;
+}
+
+void
+random_generator_restore(unsigned iseed, unsigned long draws)
+{
+  random_generator_initialize(iseed);
+  while (random_generator_draws < draws) {
+    rand();
+    random_generator_draws++;
+  }
+}
+
+/*
+ * From now on, return 1-u for each uniform u that rand() gives, i.e., the
+ * antithetic of the sequence.
+ */
+
+void
+random_generator_set_antithetic(int antithetic)
+{
+  random_generator_antithetic = antithetic;
 }
 
 /*
@@ -638,8 +1292,11 @@ uniform_generator(void)
 
   do {
     r = (double) rand()/(double) RAND_MAX;
+    random_generator_draws++;
   } while (r == 1 || r == 0);
 
+  if (random_generator_antithetic) r = 1.0 - r;
+
 if (r > 1.0) {
   printf ("***** ERROR: Random() out of bounds! ***** \n");
   exit(0);
@@ -659,16 +1316,78 @@ exponential_generator(double mean)
   return -1.0 * log(u) * mean;
 }
 
+/*
+ * Memory accounting. Each block starts with a header giving its size and
+ * tag. The union keeps the block that follows aligned for any type. Without
+ * MEMORY_REPORT there are no headers, and the accounts stay at zero.
+ */
+
+static THREAD_LOCAL Memory_Usage memory_accounts[MEMORY_TOTAL+1];
+
+static const char * memory_tag_names[MEMORY_TOTAL+1] = {
+  "events", "queues", "packets", "stations", "other", "total"
+};
+
+#if MEMORY_REPORT
+
+typedef union _memory_header_
+{
+  struct {
+    size_t size;
+    Memory_Tag tag;
+  } info;
+  long double align;
+} Memory_Header;
+
+static void
+memory_account_add(Memory_Tag tag, size_t size)
+{
+  Memory_Usage_Ptr account = &memory_accounts[tag];
+
+  account->live += (long int) size;
+  account->allocations++;
+  if (account->live > account->peak) account->peak = account->live;
+}
+
+static void *
+memory_account_block(void * block, size_t size, Memory_Tag tag)
+{
+  Memory_Header * header = (Memory_Header *) block;
+
+  if ((int) tag < 0 || tag >= MEMORY_TOTAL) tag = MEMORY_OTHER;
+  header->info.size = size;
+  header->info.tag = tag;
+  memory_account_add(tag, size);
+  memory_account_add(MEMORY_TOTAL, size);
+  return (void *) (header + 1);
+}
+
+#define MEMORY_HEADER_SIZE sizeof(Memory_Header)
+
+#else
+
+#define memory_account_block(block, size, tag) ((void) (tag), (block))
+#define MEMORY_HEADER_SIZE 0
+
+#endif
+
 /*
  * Create a front-end fo malloc that performs out-of-memory testing.
  */
 
 void *
 xmalloc(unsigned size)
+{
+  return xmalloc_tagged(size, MEMORY_OTHER);
+}
+
+void *
+xmalloc_tagged(unsigned size, Memory_Tag tag)
 {
   void * a_ptr;
 
-  if((a_ptr = (void *) malloc(size)) != NULL) return a_ptr;
+  if((a_ptr = (void *) malloc(MEMORY_HEADER_SIZE + size)) != NULL)
+    return memory_account_block(a_ptr, size, tag);
   else {
     printf("***** ERROR: Out of memory ***** \n");
     exit(1);
@@ -681,10 +1400,20 @@ xmalloc(unsigned size)
 
 void *
 xcalloc(unsigned num, unsigned size)
+{
+  return xcalloc_tagged(num, size, MEMORY_OTHER);
+}
+
+void *
+xcalloc_tagged(unsigned num, unsigned size, Memory_Tag tag)
 {
   void * a_ptr;
+  size_t bytes = (size_t) num * size;
+
+  if (size != 0 && bytes / size != num) a_ptr = NULL;
+  else a_ptr = (void *) calloc(1, MEMORY_HEADER_SIZE + bytes);
 
-  if((a_ptr = (void *) calloc(num, size)) != NULL) return a_ptr;
+  if(a_ptr != NULL) return memory_account_block(a_ptr, bytes, tag);
   else {
     printf(" ***** WARNING: Out of memory ***** \n");
     exit(1);
@@ -698,10 +1427,54 @@ xcalloc(unsigned num, unsigned size)
 void
 xfree(void * ptr)
 {
+#if MEMORY_REPORT
+  Memory_Header * header;
+#endif
+
   if(ptr == NULL) {
     printf("Warning: Attempting to free a NULL pointer.\n");
   }
-  else free(ptr);
+  else {
+#if MEMORY_REPORT
+    header = (Memory_Header *) ptr - 1;
+    memory_accounts[header->info.tag].live -= (long int) header->info.size;
+    memory_accounts[MEMORY_TOTAL].live -= (long int) header->info.size;
+    ptr = (void *) header;
+#endif
+    free(ptr);
+  }
+}
+
+/*
+ * Return the account of one tag, or of all of them with MEMORY_TOTAL.
+ */
+
+Memory_Usage
+memory_usage(Memory_Tag tag)
+{
+  return memory_accounts[tag];
+}
+
+/*
+ * Start a new run's accounts. Blocks still live from earlier runs stay
+ * counted, but the peaks and allocation counts start again from here.
+ */
+
+void
+memory_usage_reset(void)
+{
+  int tag;
+
+  for (tag=0; tag<=MEMORY_TOTAL; tag++) {
+    memory_accounts[tag].peak = memory_accounts[tag].live;
+    memory_accounts[tag].allocations = 0;
+  }
+}
+
+const char *
+memory_tag_name(Memory_Tag tag)
+{
+  return memory_tag_names[tag];
 }
 
 
@@ -41,12 +41,49 @@ struct _clock_;
 struct _event_;
 struct _event_container_;
 struct _event_list_;
+struct _event_source_;
+struct _event_trace_;
+struct _event_profile_;
+struct _rand_stream_;
+
+/*
+ * Counters that another thread reads while the simulation runs, e.g., for
+ * progress reports. Only the simulation thread writes them, so an increment
+ * is a relaxed load and store, which costs no more than a plain increment
+ * but is not a data race.
+ */
+
+#if defined(__GNUC__)
+#define COUNTER_GET(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define COUNTER_SET(counter, value) \
+  __atomic_store_n(&(counter), (value), __ATOMIC_RELAXED)
+#define COUNTER_INCREMENT(counter) \
+  COUNTER_SET(counter, COUNTER_GET(counter) + 1)
+#else
+#define COUNTER_GET(counter) (counter)
+#define COUNTER_SET(counter, value) ((counter) = (value))
+#define COUNTER_INCREMENT(counter) ((counter)++)
+#endif
+
+/*
+ * State that each thread keeps for itself, so that simulation_runs in
+ * different threads don't share it.
+ */
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
 
 /*
  * Define some convenient typedefs to use when writing simulation_runs.
  *
  * The simulation_run consists of an event list, clock and a pointer for
- * passing user data between various functions.
+ * passing user data between various functions. If trace is not NULL, every
+ * event scheduled, executed or descheduled is recorded in a binary trace. If
+ * profile is not NULL, event costs and event list operations are profiled.
+ * events_executed counts the events executed so far.
  */
 
 typedef struct _simulation_run_
@@ -54,6 +91,9 @@ typedef struct _simulation_run_
   struct _eventlist_ * eventlist;
   struct _clock_ * clock;
   void * data;
+  struct _event_trace_ * trace;
+  struct _event_profile_ * profile;
+  long int events_executed;
 } Simulation_Run, * Simulation_Run_Ptr;
 
 typedef struct _clock_
@@ -88,24 +128,77 @@ typedef struct _eventlist_
   struct _event_container_ * front_ptr;
   struct _event_container_ * back_ptr;
   int size;
+  int max_size;
+  long int next_event_id;
+  struct _event_source_ * sources;
 } Eventlist, * Eventlist_Ptr;
 
+/*
+ * An event source is a process whose next event time is known in advance,
+ * e.g., an arrival process. Sources are not kept on the event list. Each
+ * one holds only its next occurrence, which is compared against the front of
+ * the event list when the next event is executed. A source is idle after its
+ * event occurs until it is scheduled again, normally by its own event
+ * function. If the source has an interval generator, intervals can be
+ * generated block_size at a time ahead of when they are needed. If stream is
+ * not NULL, intervals are drawn from it with stream_generator instead.
+ */
+
+typedef struct _event_source_
+{
+  struct _event_source_ * next_source;
+  struct _event_ event;
+  double occurrence_time;
+  long int event_id;
+  int active;
+  double (* interval_generator)(double);
+  double (* stream_generator)(struct _rand_stream_ *, double);
+  struct _rand_stream_ * stream;
+  double interval_parameter;
+  double * intervals;
+  int block_size;
+  int next_interval;
+} Event_Source, * Event_Source_Ptr;
+
+/******************************************************************************/
+
+/*
+ * Time-weighted average of a level, e.g., a queue length or a server
+ * occupancy. The area under the level is integrated incrementally, only when
+ * the level changes, using the clock of the simulation_run it belongs to.
+ */
+
+typedef struct _time_average_
+{
+  struct _clock_ * clock;
+  double level;
+  double area;
+  double last_change_time;
+  double start_time;
+} Time_Average, * Time_Average_Ptr;
+
 /******************************************************************************/
 
 /*
  * FIFO queue object keeps the queue size and contains pointers to containers
  * at the front and back of the queue. The queue container objects are kept on
  * a singly linked list. Each container has a content pointer that tracks the
- * object placed on the FIFO queue.
+ * object placed on the FIFO queue. If occupancy is not NULL, the time-average
+ * queue length is tracked as well. If spill is not NULL, the middle of a long
+ * queue is kept in a file instead (see fifoqueue_spill.h), and the list from
+ * front_ptr only holds the head of the queue.
  */
 
 struct _queue_container_;
+struct _fifoqueue_spill_;
 
 typedef struct _fifoqueue_
 {
   struct _queue_container_ * front_ptr;
   struct _queue_container_ * back_ptr;
   int size;
+  struct _time_average_ * occupancy;
+  struct _fifoqueue_spill_ * spill;
 } Fifoqueue, * Fifoqueue_Ptr;
 
 typedef struct _queue_container_
@@ -117,7 +210,8 @@ typedef struct _queue_container_
 /******************************************************************************/
 
 /*
- * Server object and definitions. 
+ * Server object and definitions. If utilization is not NULL, the fraction of
+ * time that the server is BUSY is tracked.
  */
 
 typedef enum{FREE, BUSY} Server_State;
@@ -126,6 +220,7 @@ typedef struct _server_
 {
   Server_State state;
   void * customer_in_service;
+  struct _time_average_ * utilization;
 } Server, * Server_Ptr;
 
 /******************************************************************************/
@@ -140,14 +235,16 @@ typedef struct _server_
 
 /*
  * _rand_stream_ permits having multiple rand() streams at once. Multiple
- * Rand_Stream objects can be created and accessed via rand_stream_get.
+ * Rand_Stream objects can be created and accessed via rand_stream_get. If
+ * antithetic is set, the stream's uniforms u are returned as 1-u.
  */
 
 typedef struct _rand_stream_
 {
   unsigned seed;
   unsigned rand_max;
-  unsigned next;
+  unsigned long long next;
+  int antithetic;
 } Rand_Stream, * Rand_Stream_Ptr;
 
 /* #ifndef RAND_MAX
@@ -156,6 +253,35 @@ typedef struct _rand_stream_
 
 /******************************************************************************/
 
+/*
+ * Memory accounting
+ *
+ * Every block from xmalloc or xcalloc carries its size and a tag, so that
+ * xfree can give the bytes back to the right account. For each tag, and for
+ * MEMORY_TOTAL over all of them, the live bytes, the peak of the live bytes
+ * and the number of allocations are kept. Untagged allocations count as
+ * MEMORY_OTHER. The accounts are per thread, and a block must be freed by
+ * the thread that allocated it. Only builds with MEMORY_REPORT keep them.
+ */
+
+typedef enum {
+  MEMORY_EVENTS,
+  MEMORY_QUEUES,
+  MEMORY_PACKETS,
+  MEMORY_STATIONS,
+  MEMORY_OTHER,
+  MEMORY_TOTAL
+} Memory_Tag;
+
+typedef struct _memory_usage_
+{
+  long int live;
+  long int peak;
+  long int allocations;
+} Memory_Usage, * Memory_Usage_Ptr;
+
+/******************************************************************************/
+
 /*
  * Prototypes for functions that are available and defined in simlib.c.
  */
@@ -178,15 +304,73 @@ simulation_run_set_data(Simulation_Run_Ptr, void*);
 /* Create an alias for simulation_run_set_data. */
 #define simulation_run_attach_data simulation_run_set_data
 
+void
+simulation_run_set_trace(Simulation_Run_Ptr, struct _event_trace_ *);
+
+void
+simulation_run_set_profile(Simulation_Run_Ptr, struct _event_profile_ *);
+
 long int
 simulation_run_schedule_event(Simulation_Run_Ptr, Event, double);
 
 void *
 simulation_run_deschedule_event(Simulation_Run_Ptr, long int);
 
+int
+simulation_run_events_pending(Simulation_Run_Ptr);
+
+Event_Source_Ptr
+simulation_run_add_source(Simulation_Run_Ptr, Event, double (*)(double),
+			  double, int);
+
+long int
+event_source_schedule(Simulation_Run_Ptr, Event_Source_Ptr, double);
+
+long int
+event_source_schedule_next(Simulation_Run_Ptr, Event_Source_Ptr);
+
+double
+event_source_next_interval(Event_Source_Ptr);
+
+void
+event_source_flush(Event_Source_Ptr);
+
+void
+event_source_set_stream(Event_Source_Ptr,
+			double (*)(struct _rand_stream_ *, double),
+			struct _rand_stream_ *);
+
+void
+simulation_run_restore_time(Simulation_Run_Ptr, double);
+
+void
+simulation_run_restore_event(Simulation_Run_Ptr, Event, double, long int);
+
+void
+simulation_run_restore_source(Simulation_Run_Ptr, Event_Source_Ptr, double,
+			      long int);
+
+Time_Average_Ptr
+time_average_new(Simulation_Run_Ptr, double);
+
+void
+time_average_set(Time_Average_Ptr, double);
+
+double
+time_average_get(Time_Average_Ptr);
+
+void
+time_average_reset(Time_Average_Ptr);
+
 Fifoqueue_Ptr
 fifoqueue_new(void);
 
+void
+fifoqueue_track_occupancy(Fifoqueue_Ptr, Simulation_Run_Ptr);
+
+void
+fifoqueue_free(Fifoqueue_Ptr);
+
 void
 fifoqueue_put(Fifoqueue_Ptr, void*);
 
@@ -199,9 +383,21 @@ fifoqueue_size(Fifoqueue_Ptr);
 void *
 fifoqueue_see_front(Fifoqueue_Ptr);
 
+void
+fifoqueue_enable_spill(Fifoqueue_Ptr, unsigned, int, Memory_Tag);
+
+int
+fifoqueue_visit(Fifoqueue_Ptr, int (*)(void *, void *), void *);
+
 Server_Ptr
 server_new(void);
 
+void
+server_track_utilization(Server_Ptr, Simulation_Run_Ptr);
+
+void
+server_free(Server_Ptr);
+
 void
 server_put(Server_Ptr, void*);
 
@@ -220,6 +416,15 @@ uniform_generator(void);
 void
 random_generator_initialize(unsigned);
 
+void
+random_generator_get_state(unsigned *, unsigned long *);
+
+void
+random_generator_restore(unsigned, unsigned long);
+
+void
+random_generator_set_antithetic(int);
+
 Rand_Stream_Ptr
 rand_stream_new(unsigned);
 
@@ -241,9 +446,24 @@ xmalloc(unsigned);
 void *
 xcalloc(unsigned, unsigned);
 
+void *
+xmalloc_tagged(unsigned, Memory_Tag);
+
+void *
+xcalloc_tagged(unsigned, unsigned, Memory_Tag);
+
 void
 xfree(void*);
 
+Memory_Usage
+memory_usage(Memory_Tag);
+
+void
+memory_usage_reset(void);
+
+const char *
+memory_tag_name(Memory_Tag);
+
 void
 simulation_run_free_memory(Simulation_Run_Ptr);
 
@@ -27,22 +27,275 @@
 
 /*******************************************************************************/
 
+/*
+ * Every parameter can be overridden on the compiler command line, e.g.,
+ * -DNUMBER_OF_STATIONS=100 (see bench/scenarios.sh).
+ */
+
+#ifndef NUMBER_OF_STATIONS
 #define NUMBER_OF_STATIONS 2
+#endif
+#ifndef MEAN_PACKET_DURATION
 #define MEAN_PACKET_DURATION 1      /* normalized packet Tx time, Xr */
+#endif
+#ifndef PACKET_ARRIVAL_RATE
 #define PACKET_ARRIVAL_RATE 0.5    /* packets per Tx time */
+#endif
+#ifndef MEAN_BACKOFF_DURATION
 #define MEAN_BACKOFF_DURATION 10    /* in units of packet transmit time, Tx */
+#endif
+#ifndef GUARD_TIME
 #define GUARD_TIME 0.01 /* reservation guard time */
+#endif
 
+#ifndef MEAN_UPLOAD_DURATION
 #define MEAN_UPLOAD_DURATION 0.5    /* in units of packet transmit time, Tx */
+#endif
 
 
+#ifndef RUNLENGTH
 #define RUNLENGTH 700000
+#endif
+#ifndef BLIPRATE
 #define BLIPRATE 100000
+#endif
+#ifndef PROGRESS_INTERVAL
+#define PROGRESS_INTERVAL 1.0 /* seconds between progress reports */
+#endif
+#ifndef METRICS_UPDATE_INTERVAL
+#define METRICS_UPDATE_INTERVAL 1000 /* processed packets between live metrics updates */
+#endif
 
 
 
 /* Comma separated list of random seeds to run. */
+#ifndef RANDOM_SEED_LIST
 #define RANDOM_SEED_LIST 400072132
+#endif
+
+/*
+ * Warm-up branching. If WARMUP_LENGTH is non-zero, each seed above is run
+ * until WARMUP_LENGTH packets have been processed, and the warmed-up state is
+ * then forked once per seed in BRANCH_SEED_LIST. Each branch continues for
+ * RUNLENGTH processed packets with its own seed. The branch for the k-th seed
+ * uses the k-th mean backoff in BRANCH_BACKOFF_LIST from then on; where the
+ * list is shorter, or the value is 0, it keeps MEAN_BACKOFF_DURATION.
+ */
+
+#ifndef WARMUP_LENGTH
+#define WARMUP_LENGTH 0
+#endif
+#ifndef BRANCH_SEED_LIST
+#define BRANCH_SEED_LIST 400072133, 400072134, 400072135
+#endif
+#ifndef BRANCH_BACKOFF_LIST
+#define BRANCH_BACKOFF_LIST 0
+#endif
+
+/*
+ * Checkpointing. If CHECKPOINT is 1, the complete state of each run is saved
+ * to CHECKPOINT_FILE (formatted with the seed) every CHECKPOINT_INTERVAL
+ * processed packets, and whenever the process receives SIGUSR1. If
+ * CHECKPOINT_RESTORE is 1, a run resumes from its checkpoint file when one
+ * exists.
+ */
+
+#ifndef CHECKPOINT
+#define CHECKPOINT 0
+#endif
+#ifndef CHECKPOINT_INTERVAL
+#define CHECKPOINT_INTERVAL 100000
+#endif
+#ifndef CHECKPOINT_RESTORE
+#define CHECKPOINT_RESTORE 0
+#endif
+#ifndef CHECKPOINT_FILE
+#define CHECKPOINT_FILE "aloha_%u.ckpt"
+#endif
+
+/*
+ * Sequential stopping. If SEQUENTIAL_STOPPING is 1, a run stops as soon as
+ * the 95% confidence intervals of mean delay and throughput, from batch
+ * means, are within RELATIVE_PRECISION of their means. RUNLENGTH remains
+ * the upper limit on the run length.
+ */
+
+#ifndef SEQUENTIAL_STOPPING
+#define SEQUENTIAL_STOPPING 0
+#endif
+#ifndef RELATIVE_PRECISION
+#define RELATIVE_PRECISION 0.05
+#endif
+#ifndef INITIAL_BATCH_SIZE
+#define INITIAL_BATCH_SIZE 100
+#endif
+
+/*
+ * Warm-up detection. If WARMUP_DETECTION is 1, the end of the initial
+ * transient is found online (MSER-5) and all statistics collected before it
+ * are discarded. RUNLENGTH then counts packets processed after the warm-up.
+ */
+
+#ifndef WARMUP_DETECTION
+#define WARMUP_DETECTION 0
+#endif
+
+/*
+ * Event budget. If EVENT_BUDGET is non-zero, a run also stops after that
+ * many events. If BENCHMARK_SUMMARY is 1, each run ends with a one-line
+ * summary of its speed, memory use and event list size.
+ */
+
+#ifndef EVENT_BUDGET
+#define EVENT_BUDGET 0
+#endif
+#ifndef BENCHMARK_SUMMARY
+#define BENCHMARK_SUMMARY 0
+#endif
+
+/*
+ * If MEMORY_REPORT is 1, the results end with the heap in use, by
+ * allocation tag: live and peak bytes, and the number of allocations. Every
+ * block then carries a small header with its size and tag, which costs time
+ * and memory, so it is off by default.
+ */
+
+#ifndef MEMORY_REPORT
+#define MEMORY_REPORT 0
+#endif
+
+/*
+ * Overload. If STATION_BUFFER_CAPACITY is non-zero, a station holds at most
+ * that many packets and arrivals to a full buffer are dropped and counted.
+ * If SATURATION_DETECTION is 1, a run whose backlog keeps growing is
+ * stopped early and reported as saturated, with the statistics collected
+ * up to that point (see saturation.h for SATURATION_WINDOW,
+ * SATURATION_THRESHOLD and SATURATION_WINDOWS).
+ */
+
+#ifndef STATION_BUFFER_CAPACITY
+#define STATION_BUFFER_CAPACITY 0
+#endif
+#ifndef SATURATION_DETECTION
+#define SATURATION_DETECTION 0
+#endif
+#ifndef SATURATION_WINDOW
+#define SATURATION_WINDOW 100000
+#endif
+#ifndef SATURATION_THRESHOLD
+#define SATURATION_THRESHOLD 0.01
+#endif
+#ifndef SATURATION_WINDOWS
+#define SATURATION_WINDOWS 5
+#endif
+
+/*
+ * Out-of-core queues. If QUEUE_SPILL_SEGMENT is non-zero, the station
+ * buffers and the cloud server queue keep only their ends in memory, and
+ * move packets in the middle of a long queue to a temporary file, that many
+ * at a time (see fifoqueue_spill.h).
+ */
+
+#ifndef QUEUE_SPILL_SEGMENT
+#define QUEUE_SPILL_SEGMENT 0
+#endif
+
+/*
+ * Variance reduction. With COMMON_RANDOM_NUMBERS, the interarrival times,
+ * station choices and each station's backoffs come from random streams of
+ * their own, so runs of different parameters with the same seed stay in step
+ * (see random_streams.h). With ANTITHETIC_PAIRS, each seed is run twice,
+ * the second time with antithetic random numbers, and the mean delays of the
+ * pairs are averaged at the end.
+ */
+
+#ifndef COMMON_RANDOM_NUMBERS
+#define COMMON_RANDOM_NUMBERS 0
+#endif
+#ifndef ANTITHETIC_PAIRS
+#define ANTITHETIC_PAIRS 0
+#endif
+
+/*
+ * If CONTROL_VARIATES is 1, the results include a control-variate estimate
+ * of the mean delay, which uses the known means of the interarrival, upload,
+ * service and backoff times (see control_variates.h).
+ */
+
+#ifndef CONTROL_VARIATES
+#define CONTROL_VARIATES 0
+#endif
+
+/*
+ * Regenerative simulation. If REGENERATIVE_ESTIMATION is 1, each run also
+ * reports the mean delay and throughput estimated from its regenerative
+ * cycles (see regenerative.h). If REGENERATIVE_CYCLES is non-zero, the seeds
+ * are not run one by one. Instead, that many cycles are simulated from the
+ * empty state, shared out over REGENERATIVE_THREADS threads (one per
+ * processor with 0), and estimated together. The threads use random streams
+ * as with COMMON_RANDOM_NUMBERS, seeded from the first seed in the list.
+ */
+
+#ifndef REGENERATIVE_ESTIMATION
+#define REGENERATIVE_ESTIMATION 0
+#endif
+#ifndef REGENERATIVE_CYCLES
+#define REGENERATIVE_CYCLES 0
+#endif
+#ifndef REGENERATIVE_THREADS
+#define REGENERATIVE_THREADS 0
+#endif
+
+/*
+ * Warm start. A run started with ALOHA_WARM_START_SAVE set records a
+ * snapshot of its state every WARM_START_INTERVAL processed packets, and a
+ * run started with ALOHA_WARM_START set begins from one of them (see
+ * warm_start.h). The recording starts once the warm-up detector finds the
+ * end of the initial transient, or without WARMUP_DETECTION, after the first
+ * WARM_START_SKIP processed packets.
+ */
+
+#ifndef WARM_START_INTERVAL
+#define WARM_START_INTERVAL 10000
+#endif
+#ifndef WARM_START_SKIP
+#define WARM_START_SKIP 100000
+#endif
+
+/*
+ * Rare-event splitting. If RESTART_SPLITTING is 1, each run estimates
+ * P(delay > TAIL_DELAY_THRESHOLD) by RESTART (see restart.h). Its importance
+ * is the backlog with RESTART_IMPORTANCE 0, or the age of the oldest packet
+ * in the system with 1. A trial crossing the i-th of RESTART_THRESHOLDS
+ * upwards is split into the i-th of RESTART_SPLITS trials. This needs
+ * fork(), so on Windows the run is not split.
+ */
+
+#ifndef RESTART_SPLITTING
+#define RESTART_SPLITTING 0
+#endif
+#ifndef RESTART_IMPORTANCE
+#define RESTART_IMPORTANCE 1
+#endif
+#ifndef RESTART_THRESHOLDS
+#define RESTART_THRESHOLDS 100, 200, 300
+#endif
+#ifndef RESTART_SPLITS
+#define RESTART_SPLITS 4, 4, 4
+#endif
+#ifndef TAIL_DELAY_THRESHOLD
+#define TAIL_DELAY_THRESHOLD 400
+#endif
+
+/*
+ * Interarrival times are generated ARRIVAL_BLOCK_SIZE at a time, ahead of
+ * the arrivals that use them. With 0, each one is generated when its arrival
+ * is scheduled, which keeps the random number sequence of earlier versions.
+ */
+
+#ifndef ARRIVAL_BLOCK_SIZE
+#define ARRIVAL_BLOCK_SIZE 0
+#endif
 
 /*******************************************************************************/
 
@@ -0,0 +1,99 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include "simparameters.h"
+#include "main.h"
+#include "statistics.h"
+
+/*******************************************************************************/
+
+/*
+ * Discard all statistics collected so far, without touching the state of the
+ * system (clock, event list, buffers, channel and cloud server). Packets that
+ * are already in the system keep their arrival times and are counted when they
+ * complete.
+ */
+
+void
+statistics_reset(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  Station_Ptr station;
+  int i;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  COUNTER_SET(data->arrival_count, 0);
+  data->packets_transmitted = 0;
+  COUNTER_SET(data->packets_processed, 0);
+  data->number_of_collisions = 0;
+  data->packets_dropped = 0;
+  data->accumulated_delay = 0.0;
+  delay_stats_initialize(&data->delay_stats);
+
+  batch_means_initialize(&data->delay_batches, INITIAL_BATCH_SIZE,
+			 simulation_run_get_time(simulation_run));
+  control_variates_initialize(&data->control_variates, INITIAL_BATCH_SIZE,
+			      data->control_variates.known_mean);
+  regenerative_initialize(&data->regeneration,
+			  data->regeneration.cycle_limit);
+
+  for(i=0; i<NUMBER_OF_STATIONS; i++) {
+    station = data->stations + i;
+    station->arrival_count = 0;
+    station->packets_transmitted = 0;
+    station->packets_processed = 0;
+    station->number_of_collisions = 0;
+    station->packets_dropped = 0;
+    station->accumulated_delay = 0.0;
+    station->mean_delay = 0;
+    delay_stats_initialize(&station->delay_stats);
+    time_average_reset(station->buffer->occupancy);
+  }
+
+  time_average_reset(data->cloud_server_queue->occupancy);
+  time_average_reset(data->cloud_server->utilization);
+  time_average_reset(data->channel->busy);
+  time_average_reset(data->channel->collision);
+}
+
+/*
+ * Called when the warm-up detector finds the end of the initial transient.
+ * The statistics are discarded from this point back to time zero. This is a
+ * little later than the MSER truncation point itself, but per-station
+ * statistics can't be rolled back to an earlier point.
+ */
+
+void
+statistics_truncate_warmup(Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  data->warmup.truncation_time = simulation_run_get_time(simulation_run);
+  data->warmup.truncated_packets = data->packets_processed;
+  statistics_reset(simulation_run);
+}
+
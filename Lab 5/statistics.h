@@ -0,0 +1,47 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _STATISTICS_H_
+#define _STATISTICS_H_
+
+/*******************************************************************************/
+
+#include "main.h"
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+statistics_reset(Simulation_Run_Ptr);
+
+void
+statistics_truncate_warmup(Simulation_Run_Ptr);
+
+/*******************************************************************************/
+
+#endif /* statistics.h */
+
@@ -0,0 +1,127 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+/*
+ * Convert a columnar packet export file (see packet_export.h) to CSV: one
+ * row per packet, or with -attempts, one row per transmission attempt.
+ *
+ * Build with:  cc -o packet_export_decode tools/packet_export_decode.c
+ * Usage:       packet_export_decode [-attempts] export_file
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../packet_export.h"
+
+/*******************************************************************************/
+
+int
+main(int argc, char * argv[])
+{
+  char magic[8], name[16], type[4];
+  uint32_t file_header[2], block_header[2];
+  uint32_t i, column;
+  Packet_Export_Block_Ptr block;
+  FILE * fp;
+  int attempts = 0;
+
+  if (argc > 1 && strcmp(argv[1], "-attempts") == 0) {
+    attempts = 1;
+    argc--;
+    argv++;
+  }
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: packet_export_decode [-attempts] export_file\n");
+    return 1;
+  }
+
+  if ((fp = fopen(argv[1], "rb")) == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  if (fread(magic, sizeof(magic), 1, fp) != 1 ||
+      memcmp(magic, PACKET_EXPORT_MAGIC, sizeof(magic)) != 0 ||
+      fread(file_header, sizeof(file_header), 1, fp) != 1 ||
+      file_header[0] != PACKET_EXPORT_VERSION ||
+      file_header[1] != PACKET_EXPORT_COLUMNS) {
+    fprintf(stderr, "%s: not a version %d packet export\n", argv[1],
+	    PACKET_EXPORT_VERSION);
+    return 1;
+  }
+
+  for (column = 0; column < file_header[1]; column++) {
+    if (fread(name, sizeof(name), 1, fp) != 1 ||
+	fread(type, sizeof(type), 1, fp) != 1) return 1;
+    if (!attempts) printf("%s%.16s", column > 0 ? "," : "", name);
+  }
+  printf(attempts ? "id,attempt_time\n" : "\n");
+
+  block = (Packet_Export_Block_Ptr) malloc(sizeof(Packet_Export_Block));
+
+  while (fread(block_header, sizeof(block_header), 1, fp) == 1) {
+    size_t n = block_header[0], m = block_header[1];
+
+    if (n > PACKET_EXPORT_BLOCK_ROWS || m > PACKET_EXPORT_BLOCK_ROWS ||
+	fread(block->id, sizeof(block->id[0]), n, fp) != n ||
+	fread(block->station_id, sizeof(block->station_id[0]), n, fp) != n ||
+	fread(block->attempts, sizeof(block->attempts[0]), n, fp) != n ||
+	fread(block->arrive_time, sizeof(double), n, fp) != n ||
+	fread(block->first_transmit_time, sizeof(double), n, fp) != n ||
+	fread(block->success_time, sizeof(double), n, fp) != n ||
+	fread(block->cloud_start_time, sizeof(double), n, fp) != n ||
+	fread(block->cloud_end_time, sizeof(double), n, fp) != n ||
+	fread(block->attempt_id, sizeof(block->attempt_id[0]), m, fp) != m ||
+	fread(block->attempt_time, sizeof(double), m, fp) != m) {
+      fprintf(stderr, "%s: truncated block\n", argv[1]);
+      return 1;
+    }
+
+    if (attempts) {
+      for (i = 0; i < m; i++) {
+	printf("%lld,%.6f\n", (long long) block->attempt_id[i],
+	       block->attempt_time[i]);
+      }
+      continue;
+    }
+
+    for (i = 0; i < n; i++) {
+      printf("%lld,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+	     (long long) block->id[i], (int) block->station_id[i],
+	     (int) block->attempts[i], block->arrive_time[i],
+	     block->first_transmit_time[i], block->success_time[i],
+	     block->cloud_start_time[i], block->cloud_end_time[i]);
+    }
+  }
+
+  free(block);
+  fclose(fp);
+  return 0;
+}
+
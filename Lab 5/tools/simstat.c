@@ -0,0 +1,187 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+/*
+ * Show the live metrics of running simulations (see metrics.h). With no
+ * arguments every metrics page in /dev/shm is shown. With -w, the pages are
+ * shown again every interval seconds until they are all gone.
+ *
+ * Build with:  cc -o simstat tools/simstat.c
+ * Usage:       simstat [-w interval] [page_name ...]
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../metrics.h"
+
+/*******************************************************************************/
+
+#define MAX_READ_ATTEMPTS 100000
+
+/*
+ * Copy a consistent snapshot of a page. Returns 0 on success and -1 if the
+ * page isn't a metrics page (yet), or is never consistent, e.g., because its
+ * simulation died in the middle of an update.
+ */
+
+static int
+read_page(const Metrics_Page * page, Metrics_Page_Ptr copy, size_t size)
+{
+  uint32_t before, after;
+  int attempt;
+
+  if (memcmp((const void *) page->magic, METRICS_MAGIC,
+	     sizeof(page->magic)) != 0) return -1;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+  for (attempt=0; attempt<MAX_READ_ATTEMPTS; attempt++) {
+    before = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+    if (before & 1) continue;
+
+    memcpy((void *) copy, (const void *) page, size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    after = __atomic_load_n(&page->sequence, __ATOMIC_RELAXED);
+
+    if (before == after) {
+      copy->finished = __atomic_load_n(&page->finished, __ATOMIC_ACQUIRE);
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Show one page. Returns 0 if it was shown.
+ */
+
+static int
+show_page(const char * name)
+{
+  Metrics_Page_Ptr copy;
+  struct stat status;
+  void * mapping;
+  uint32_t i;
+  int fd;
+
+  if ((fd = shm_open(name, O_RDONLY, 0)) < 0) return -1;
+  if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(Metrics_Page) ||
+      (mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0)) ==
+      MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+  close(fd);
+
+  copy = (Metrics_Page_Ptr) malloc(status.st_size);
+  if (read_page((const Metrics_Page *) mapping, copy, status.st_size) != 0 ||
+      copy->version != METRICS_VERSION ||
+      METRICS_PAGE_SIZE(copy->number_of_stations) > (size_t) status.st_size) {
+    munmap(mapping, status.st_size);
+    free(copy);
+    return -1;
+  }
+  munmap(mapping, status.st_size);
+
+  printf("%s  pid %ld  seed %u%s\n", name, (long) copy->pid,
+	 copy->random_seed, copy->finished ? "  (finished)" : "");
+  printf("  clock %.1f  events %lld  arrivals %lld  transmissions %lld  "
+	 "collisions %lld  processed %lld\n", copy->clock,
+	 (long long) copy->events, (long long) copy->arrivals,
+	 (long long) copy->transmissions, (long long) copy->collisions,
+	 (long long) copy->processed);
+  printf("  delay: mean %.3f  std dev %.3f  p50 %.3f  p99 %.3f\n",
+	 copy->mean_delay, copy->delay_std_dev, copy->delay_p50,
+	 copy->delay_p99);
+
+  for (i=0; i<copy->number_of_stations; i++) {
+    printf("  station %2u: queue %lld  arrivals %lld  processed %lld  "
+	   "mean delay %.3f\n", i, (long long) copy->stations[i].queue_length,
+	   (long long) copy->stations[i].arrivals,
+	   (long long) copy->stations[i].processed,
+	   copy->stations[i].mean_delay);
+  }
+
+  free(copy);
+  return 0;
+}
+
+/*
+ * Show every metrics page in /dev/shm. Returns the number shown.
+ */
+
+static int
+show_all_pages(void)
+{
+  char name[300];
+  struct dirent * entry;
+  DIR * directory;
+  int shown = 0;
+
+  if ((directory = opendir("/dev/shm")) == NULL) return 0;
+
+  while ((entry = readdir(directory)) != NULL) {
+    if (entry->d_name[0] == '.') continue;
+    snprintf(name, sizeof(name), "/%s", entry->d_name);
+    if (show_page(name) == 0) shown++;
+  }
+  closedir(directory);
+  return shown;
+}
+
+int
+main(int argc, char * argv[])
+{
+  double interval = 0.0;
+  int i, first = 1, shown;
+
+  if (argc > 2 && strcmp(argv[1], "-w") == 0) {
+    interval = atof(argv[2]);
+    first = 3;
+  } else if (argc > 1 && argv[1][0] == '-') {
+    fprintf(stderr, "Usage: simstat [-w interval] [page_name ...]\n");
+    return 1;
+  }
+
+  do {
+    shown = 0;
+    if (first == argc) shown = show_all_pages();
+    else for (i=first; i<argc; i++) shown += show_page(argv[i]) == 0;
+
+    if (interval > 0 && shown > 0) {
+      printf("\n");
+      fflush(stdout);
+      usleep((useconds_t) (1e6 * interval));
+    }
+  } while (interval > 0 && shown > 0);
+
+  return 0;
+}
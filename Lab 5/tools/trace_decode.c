@@ -0,0 +1,122 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+/*
+ * Decode a binary event trace (see event_trace.h) to text or CSV.
+ *
+ * Build with:  cc -o trace_decode tools/trace_decode.c
+ * Usage:       trace_decode [-csv] trace_file
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../event_trace.h"
+
+/*******************************************************************************/
+
+static const char * operation_names[] = {"schedule", "execute", "deschedule"};
+static const char * channel_state_names[] = {"IDLE", "SUCCESS", "COLLISION"};
+
+int
+main(int argc, char * argv[])
+{
+  Trace_Header header;
+  Trace_Record record;
+  FILE * fp;
+  uint64_t first, i;
+  const char * description, * channel_state;
+  int csv = 0;
+
+  if (argc > 1 && strcmp(argv[1], "-csv") == 0) {
+    csv = 1;
+    argc--;
+    argv++;
+  }
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: trace_decode [-csv] trace_file\n");
+    return 1;
+  }
+
+  if ((fp = fopen(argv[1], "rb")) == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  if (fread(&header, sizeof(header), 1, fp) != 1 ||
+      memcmp(header.magic, EVENT_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != EVENT_TRACE_VERSION ||
+      header.record_size != sizeof(Trace_Record)) {
+    fprintf(stderr, "%s: not a version %d event trace\n", argv[1],
+	    EVENT_TRACE_VERSION);
+    return 1;
+  }
+
+  /* If the ring has wrapped, the oldest record follows the newest. */
+  first = header.records_written > header.capacity ?
+    header.records_written - header.capacity : 0;
+
+  if (csv) {
+    printf("sequence,time,operation,event_type,event_time,event_id,"
+	   "station_id,packet_id,channel_state\n");
+  } else {
+    printf("%llu records written, %llu kept\n",
+	   (unsigned long long) header.records_written,
+	   (unsigned long long) (header.records_written - first));
+  }
+
+  for (i = first; i < header.records_written; i++) {
+
+    fseek(fp, (long) (sizeof(header) +
+		      (i % header.capacity) * sizeof(Trace_Record)), SEEK_SET);
+    if (fread(&record, sizeof(record), 1, fp) != 1) break;
+
+    description = record.event_type < header.number_of_types ?
+      header.descriptions[record.event_type] : "?";
+    channel_state = record.channel_state >= 0 && record.channel_state <= 2 ?
+      channel_state_names[(int) record.channel_state] : "";
+
+    if (csv) {
+      printf("%llu,%.6f,%s,\"%s\",%.6f,%lld,%d,%lld,%s\n",
+	     (unsigned long long) i, record.time,
+	     operation_names[record.operation % 3], description,
+	     record.event_time, (long long) record.event_id,
+	     (int) record.station_id, (long long) record.packet_id,
+	     channel_state);
+    } else {
+      printf("%12.4f %-10s %-22s at %12.4f  id %-8lld stn %-4d pkt %-8lld %s\n",
+	     record.time, operation_names[record.operation % 3], description,
+	     record.event_time, (long long) record.event_id,
+	     (int) record.station_id, (long long) record.packet_id,
+	     channel_state);
+    }
+  }
+
+  fclose(fp);
+  return 0;
+}
+
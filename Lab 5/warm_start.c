@@ -0,0 +1,372 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simparameters.h"
+#include "main.h"
+#include "packet_transmission.h"
+#include "random_streams.h"
+#include "warm_start.h"
+
+/*******************************************************************************/
+
+/*
+ * A warm-start file is a header, followed by the snapshots. Each snapshot is
+ * the number of packets in each station buffer and at the cloud server
+ * (including the one in service), then the packets themselves, station by
+ * station, in queue order. The header holds the parameters the snapshots
+ * were taken at, and is rewritten with the number of snapshots at the end.
+ */
+
+#define WARM_START_MAGIC "ALOHAWRM"
+#define SNAPSHOT_COUNTS (NUMBER_OF_STATIONS+1)
+
+typedef struct _warm_start_header_
+{
+  char magic[8];
+  unsigned number_of_stations;
+  unsigned record_size;
+  double packet_arrival_rate;
+  double mean_backoff_duration;
+  double mean_upload_duration;
+  double mean_packet_duration;
+  long int snapshots;
+} Warm_Start_Header;
+
+typedef struct _snapshot_writer_
+{
+  FILE * fp;
+  double now;
+} Snapshot_Writer;
+
+/*******************************************************************************/
+
+static void
+warm_start_header(Warm_Start_Header * header, long int snapshots)
+{
+  memset(header, 0, sizeof(Warm_Start_Header));
+  memcpy(header->magic, WARM_START_MAGIC, sizeof(header->magic));
+  header->number_of_stations = NUMBER_OF_STATIONS;
+  header->record_size = sizeof(Warm_Start_Packet);
+  header->packet_arrival_rate = PACKET_ARRIVAL_RATE;
+  header->mean_backoff_duration = MEAN_BACKOFF_DURATION;
+  header->mean_upload_duration = MEAN_UPLOAD_DURATION;
+  header->mean_packet_duration = MEAN_PACKET_DURATION;
+  header->snapshots = snapshots;
+}
+
+static void
+write_or_exit(const void * ptr, size_t size, size_t count, FILE * fp)
+{
+  if (fwrite(ptr, size, count, fp) != count) {
+    printf("Error: Cannot write the warm-start file.\n");
+    exit(1);
+  }
+}
+
+static void
+read_or_exit(void * ptr, size_t size, size_t count, FILE * fp)
+{
+  if (fread(ptr, size, count, fp) != count) {
+    printf("Error: Warm-start file is truncated.\n");
+    exit(1);
+  }
+}
+
+/*******************************************************************************/
+
+/*
+ * Start recording snapshots in a new warm-start file.
+ */
+
+Warm_Start_Ptr
+warm_start_record(const char * file_name)
+{
+  Warm_Start_Ptr warm_start;
+  Warm_Start_Header header;
+
+  warm_start = (Warm_Start_Ptr) xcalloc(1, sizeof(Warm_Start));
+  if ((warm_start->fp = fopen(file_name, "wb")) == NULL) {
+    printf("Error: Cannot create warm-start file %s.\n", file_name);
+    exit(1);
+  }
+
+  warm_start_header(&header, 0);
+  write_or_exit(&header, sizeof(header), 1, warm_start->fp);
+  return warm_start;
+}
+
+static int
+write_packet(void * packet_ptr, void * writer_ptr)
+{
+  Packet_Ptr packet = (Packet_Ptr) packet_ptr;
+  Snapshot_Writer * writer = (Snapshot_Writer *) writer_ptr;
+  Warm_Start_Packet record;
+
+  record.age = (float) (writer->now - packet->arrive_time);
+  record.upload_time = (float) packet->upload_time;
+  record.service_time = (float) packet->service_time;
+  record.station_id = (int16_t) packet->station_id;
+  record.collision_count = (int16_t) packet->collision_count;
+  write_or_exit(&record, sizeof(record), 1, writer->fp);
+  return 0;
+}
+
+/*
+ * Called after each event. Takes a snapshot each time another
+ * WARM_START_INTERVAL packets have been processed in the run, except during
+ * the run's own warm-up.
+ */
+
+void
+warm_start_poll(Warm_Start_Ptr warm_start, Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  Snapshot_Writer writer;
+  uint32_t counts[SNAPSHOT_COUNTS];
+  long int processed;
+  int i, busy;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+
+  processed = data->packets_processed;
+  if (processed == warm_start->last_processed) return;
+  warm_start->last_processed = processed;
+  if (processed == 0 || processed % WARM_START_INTERVAL != 0) return;
+
+#if WARMUP_DETECTION
+  if (!data->warmup.done) return;
+#else
+  if (processed <= WARM_START_SKIP) return;
+#endif
+
+  busy = server_state(data->cloud_server) == BUSY;
+  for (i=0; i<NUMBER_OF_STATIONS; i++)
+    counts[i] = (uint32_t) fifoqueue_size((data->stations+i)->buffer);
+  counts[NUMBER_OF_STATIONS] =
+    (uint32_t) (fifoqueue_size(data->cloud_server_queue) + busy);
+  write_or_exit(counts, sizeof(uint32_t), SNAPSHOT_COUNTS, warm_start->fp);
+
+  writer.fp = warm_start->fp;
+  writer.now = simulation_run_get_time(simulation_run);
+  for (i=0; i<NUMBER_OF_STATIONS; i++)
+    fifoqueue_visit((data->stations+i)->buffer, write_packet, (void *) &writer);
+  if (busy)
+    write_packet(data->cloud_server->customer_in_service, (void *) &writer);
+  fifoqueue_visit(data->cloud_server_queue, write_packet, (void *) &writer);
+
+  warm_start->snapshots++;
+}
+
+/*
+ * Finish the file being recorded.
+ */
+
+void
+warm_start_close(Warm_Start_Ptr warm_start)
+{
+  Warm_Start_Header header;
+
+  warm_start_header(&header, warm_start->snapshots);
+  if (fseek(warm_start->fp, 0L, SEEK_SET) != 0) {
+    printf("Error: Cannot write the warm-start file.\n");
+    exit(1);
+  }
+  write_or_exit(&header, sizeof(header), 1, warm_start->fp);
+  if (fclose(warm_start->fp) != 0) {
+    printf("Error: Cannot write the warm-start file.\n");
+    exit(1);
+  }
+
+  printf("Saved %ld warm-start snapshots\n", warm_start->snapshots);
+  xfree(warm_start);
+}
+
+/*******************************************************************************/
+
+/*
+ * Read all of the snapshots in a warm-start file, which must have been
+ * recorded at the same parameters.
+ */
+
+Warm_Start_Ptr
+warm_start_load(const char * file_name)
+{
+  Warm_Start_Ptr warm_start;
+  Warm_Start_Header header, expected;
+  FILE * fp;
+  long int file_size, packets, snapshot, p = 0, size;
+  int i;
+
+  if ((fp = fopen(file_name, "rb")) == NULL) {
+    printf("Error: Cannot open warm-start file %s.\n", file_name);
+    exit(1);
+  }
+
+  read_or_exit(&header, sizeof(header), 1, fp);
+  warm_start_header(&expected, header.snapshots);
+  if (memcmp(&header, &expected, sizeof(header)) != 0 ||
+      header.snapshots < 1) {
+    printf("Error: Warm-start file %s does not match this simulation.\n",
+	   file_name);
+    exit(1);
+  }
+
+  /* Whatever follows the counts is packets. */
+  if (fseek(fp, 0L, SEEK_END) != 0 || (file_size = ftell(fp)) < 0 ||
+      fseek(fp, (long int) sizeof(header), SEEK_SET) != 0) {
+    printf("Error: Cannot read warm-start file %s.\n", file_name);
+    exit(1);
+  }
+  packets = (file_size - (long int) sizeof(header) -
+	     header.snapshots * SNAPSHOT_COUNTS * (long int) sizeof(uint32_t))/
+    (long int) sizeof(Warm_Start_Packet);
+  if (packets < 0) packets = 0;
+
+  warm_start = (Warm_Start_Ptr) xcalloc(1, sizeof(Warm_Start));
+  warm_start->snapshots = header.snapshots;
+  warm_start->counts = (uint32_t *)
+    xcalloc((unsigned) (header.snapshots * SNAPSHOT_COUNTS), sizeof(uint32_t));
+  warm_start->first_packet = (long int *)
+    xcalloc((unsigned) header.snapshots + 1, sizeof(long int));
+  warm_start->packets = (Warm_Start_Packet_Ptr)
+    xcalloc((unsigned) packets + 1, sizeof(Warm_Start_Packet));
+
+  for (snapshot=0; snapshot<header.snapshots; snapshot++) {
+    uint32_t * counts = warm_start->counts + snapshot*SNAPSHOT_COUNTS;
+
+    read_or_exit(counts, sizeof(uint32_t), SNAPSHOT_COUNTS, fp);
+    warm_start->first_packet[snapshot] = p;
+    for (size=0, i=0; i<SNAPSHOT_COUNTS; i++) size += counts[i];
+    if (p + size > packets) {
+      printf("Error: Warm-start file is truncated.\n");
+      exit(1);
+    }
+    read_or_exit(warm_start->packets + p, sizeof(Warm_Start_Packet),
+		 (size_t) size, fp);
+    p += size;
+  }
+  warm_start->first_packet[header.snapshots] = p;
+
+  fclose(fp);
+  return warm_start;
+}
+
+static Packet_Ptr
+warm_start_packet(Simulation_Run_Data_Ptr data, Warm_Start_Packet_Ptr record,
+		  double now)
+{
+  Packet_Ptr packet;
+
+  packet = (Packet_Ptr) xmalloc_tagged(sizeof(Packet), MEMORY_PACKETS);
+  packet->id = data->next_packet_id++;
+  packet->arrive_time = now - record->age;
+  packet->first_transmit_time = -1.0;
+  packet->success_time = -1.0;
+  packet->cloud_start_time = -1.0;
+  packet->service_time = record->service_time;
+  packet->upload_time = record->upload_time;
+  packet->status = WAITING;
+  packet->collision_count = record->collision_count;
+  packet->backoff_excess = 0.0;
+  packet->station_id = record->station_id;
+  /* At its mean, so that it doesn't move the control variates. */
+  packet->interarrival_time = 1.0/PACKET_ARRIVAL_RATE;
+  data->packets_in_system++;
+  return packet;
+}
+
+/*
+ * Put a fresh simulation_run into the state of one of the snapshots. The
+ * snapshot is picked with a stream of its own, seeded with the run's seed,
+ * so both runs of an antithetic pair start from the same one.
+ */
+
+void
+warm_start_sample(Warm_Start_Ptr warm_start, Simulation_Run_Ptr simulation_run)
+{
+  Simulation_Run_Data_Ptr data;
+  Rand_Stream stream;
+  Warm_Start_Packet_Ptr record;
+  Packet_Ptr packet;
+  uint32_t * counts;
+  double now, backoff_duration;
+  long int snapshot;
+  uint32_t k;
+  int i;
+
+  data = (Simulation_Run_Data_Ptr) simulation_run_data(simulation_run);
+  now = simulation_run_get_time(simulation_run);
+
+  rand_stream_initialize(&stream, data->random_seed);
+  snapshot = (long int) (rand_stream_uniform_generator(&stream) *
+			 warm_start->snapshots);
+  if (snapshot >= warm_start->snapshots) snapshot = warm_start->snapshots - 1;
+
+  counts = warm_start->counts + snapshot*SNAPSHOT_COUNTS;
+  record = warm_start->packets + warm_start->first_packet[snapshot];
+
+  /* Each station's first packet backs off before transmitting, as if it
+     had just collided. */
+  for (i=0; i<NUMBER_OF_STATIONS; i++) {
+    for (k=0; k<counts[i]; k++) {
+      packet = warm_start_packet(data, record++, now);
+      fifoqueue_put((data->stations+i)->buffer, (void *) packet);
+      if (k == 0) {
+	backoff_duration = 2.0 * random_backoff_uniform(data, i) *
+	  data->mean_backoff_duration;
+	packet->backoff_excess += backoff_duration - data->mean_backoff_duration;
+	schedule_transmission_start_event(simulation_run,
+					  now + backoff_duration,
+					  (void *) packet);
+      }
+    }
+  }
+
+  for (k=0; k<counts[NUMBER_OF_STATIONS]; k++) {
+    packet = warm_start_packet(data, record++, now);
+    if (k == 0)
+      start_processing_on_cloud_server(simulation_run, packet,
+				       data->cloud_server);
+    else fifoqueue_put(data->cloud_server_queue, (void *) packet);
+  }
+
+  /* The backlog starts where the snapshot left it. */
+  saturation_detector_initialize(&data->saturation, data->packets_in_system);
+
+  printf("Warm start from snapshot %ld of %ld (%ld packets in the system)\n",
+	 snapshot + 1, warm_start->snapshots, data->packets_in_system);
+}
+
+void
+warm_start_free(Warm_Start_Ptr warm_start)
+{
+  xfree(warm_start->counts);
+  xfree(warm_start->first_packet);
+  xfree(warm_start->packets);
+  xfree(warm_start);
+}
+
@@ -0,0 +1,100 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _WARM_START_H_
+#define _WARM_START_H_
+
+/*******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include "simlib.h"
+
+/*******************************************************************************/
+
+/*
+ * Steady-state warm start. Once its own initial transient is over, a long
+ * run can record snapshots of its state, every WARM_START_INTERVAL processed
+ * packets, in a warm-start file: the packets in each station buffer and at
+ * the cloud server, in order, each with its age and the little else needed
+ * to recreate it. A later run at the same parameters then starts from one of
+ * the snapshots, chosen at random by its seed, instead of from an empty
+ * system, so that it needs little or no warm-up.
+ *
+ * The snapshot is recreated with the channel IDLE. The packet at the head of
+ * each station buffer starts transmitting after a backoff, and the first
+ * packet at the cloud server starts its service.
+ */
+
+typedef struct _warm_start_packet_
+{
+  float age;
+  float upload_time;
+  float service_time;
+  int16_t station_id;
+  int16_t collision_count;
+} Warm_Start_Packet, * Warm_Start_Packet_Ptr;
+
+typedef struct _warm_start_
+{
+  /* Recording: the file, and the processed packets seen last. */
+  FILE * fp;
+  long int last_processed;
+  long int snapshots;
+
+  /* Loaded: the number of packets in each station buffer and at the cloud
+     server, for each snapshot, and where its packets start. */
+  uint32_t * counts;
+  long int * first_packet;
+  Warm_Start_Packet_Ptr packets;
+} Warm_Start, * Warm_Start_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+Warm_Start_Ptr
+warm_start_record(const char *);
+
+void
+warm_start_poll(Warm_Start_Ptr, Simulation_Run_Ptr);
+
+void
+warm_start_close(Warm_Start_Ptr);
+
+Warm_Start_Ptr
+warm_start_load(const char *);
+
+void
+warm_start_sample(Warm_Start_Ptr, Simulation_Run_Ptr);
+
+void
+warm_start_free(Warm_Start_Ptr);
+
+/*******************************************************************************/
+
+#endif /* warm_start.h */
+
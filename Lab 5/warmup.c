@@ -0,0 +1,108 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#include "warmup.h"
+
+/*******************************************************************************/
+
+void
+warmup_detector_initialize(Warmup_Detector_Ptr detector)
+{
+  detector->batch_size = MSER_BATCH_SIZE;
+  detector->count = 0;
+  detector->sum = 0.0;
+  detector->number_of_batches = 0;
+  detector->done = 0;
+  detector->truncation_batch = 0;
+  detector->truncation_time = 0.0;
+  detector->truncated_packets = 0;
+}
+
+/*
+ * Add a delay observation. Returns 1 when the end of the initial transient
+ * has just been found, and 0 otherwise.
+ */
+
+int
+warmup_detector_add(Warmup_Detector_Ptr detector, double delay)
+{
+  int i, d;
+
+  detector->sum += delay;
+  if (++detector->count < detector->batch_size) return 0;
+
+  detector->mean[detector->number_of_batches++] =
+    detector->sum/detector->count;
+  detector->count = 0;
+  detector->sum = 0.0;
+
+  if (detector->number_of_batches < MSER_MAX_BATCHES) return 0;
+
+  d = mser_truncation_point(detector->mean, detector->number_of_batches);
+
+  if (d < detector->number_of_batches/2) {
+    detector->done = 1;
+    detector->truncation_batch = d;
+    return 1;
+  }
+
+  /* Not enough data yet. Merge batches and keep going. */
+  for (i=0; i<MSER_MAX_BATCHES/2; i++) {
+    detector->mean[i] = (detector->mean[2*i] + detector->mean[2*i+1])/2;
+  }
+  detector->number_of_batches = MSER_MAX_BATCHES/2;
+  detector->batch_size *= 2;
+  return 0;
+}
+
+/*
+ * Find the MSER truncation point of a series of n values, i.e., the d that
+ * minimizes the variance of the mean of the values from d onwards,
+ *
+ *   sum_{i>=d} (x_i - mean_d)^2 / (n-d)^2.
+ *
+ * Suffix sums make this a single O(n) pass from the back.
+ */
+
+int
+mser_truncation_point(double * x, int n)
+{
+  double sum = 0.0, sum_of_squares = 0.0, statistic, best = -1.0;
+  int d, m, best_d = 0;
+
+  for (d=n-1; d>=0; d--) {
+    sum += x[d];
+    sum_of_squares += x[d]*x[d];
+    m = n - d;
+
+    if (m < 2) continue;
+    statistic = (sum_of_squares - sum*sum/m)/((double) m*m);
+    if (best < 0.0 || statistic <= best) {
+      best = statistic;
+      best_d = d;
+    }
+  }
+  return best_d;
+}
+
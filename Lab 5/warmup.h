@@ -0,0 +1,72 @@
+
+/*
+ * Simulation_Run of the ALOHA Protocol
+ * 
+ * Copyright (C) 2014 Terence D. Todd Hamilton, Ontario, CANADA
+ * todd@mcmaster.ca
+ * 
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 3 of the License, or (at your option)
+ * any later version.
+ * 
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ * 
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+/*******************************************************************************/
+
+#ifndef _WARMUP_H_
+#define _WARMUP_H_
+
+/*******************************************************************************/
+
+/*
+ * MSER-5 warm-up detection. Packet delays are averaged over batches of
+ * MSER_BATCH_SIZE packets. Whenever MSER_MAX_BATCHES batch means have been
+ * collected, the MSER truncation point is computed. If it lies in the first
+ * half of the data, the initial transient is over. Otherwise, adjacent
+ * batches are merged and collection continues with batches twice as long.
+ */
+
+#define MSER_BATCH_SIZE 5
+#define MSER_MAX_BATCHES 512
+
+typedef struct _warmup_detector_
+{
+  long int batch_size;
+  long int count;
+  double sum;
+  int number_of_batches;
+  double mean[MSER_MAX_BATCHES];
+  int done;
+  int truncation_batch;
+  double truncation_time;
+  long int truncated_packets;
+} Warmup_Detector, * Warmup_Detector_Ptr;
+
+/*******************************************************************************/
+
+/*
+ * Function prototypes
+ */
+
+void
+warmup_detector_initialize(Warmup_Detector_Ptr);
+
+int
+warmup_detector_add(Warmup_Detector_Ptr, double);
+
+int
+mser_truncation_point(double *, int);
+
+/*******************************************************************************/
+
+#endif /* warmup.h */
+